@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Runs one phase (read, parse, solve, ...) of a day many times after a few warm-up
+// runs and records the distribution of wall-clock times, rather than one `time` over
+// the whole process which mixes in startup and I/O noise.
+
+typedef struct Config {
+		size_t warmup = 5;
+		size_t iterations = 101;
+} config_t;
+
+typedef struct Stats {
+		std::string day;
+		std::string input;
+		std::string phase;
+		size_t iterations;
+		double min_ns;
+		double median_ns;
+		double mean_ns;
+		double p99_ns;
+} stats_t;
+
+// keep the compiler from optimising away a result that is otherwise unused
+template <typename T>
+inline void
+do_not_optimize(const T &value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename F>
+stats_t
+measure(const std::string &day, const std::string &input, const std::string &phase,
+        const config_t &config, F &&f) {
+	for (size_t i = 0; i < config.warmup; i++) {
+		do_not_optimize(f());
+	}
+
+	std::vector<double> samples;
+	samples.reserve(config.iterations);
+
+	for (size_t i = 0; i < config.iterations; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		do_not_optimize(f());
+		const auto end = std::chrono::steady_clock::now();
+
+		samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	double total = 0;
+	for (auto s : samples) {
+		total += s;
+	}
+
+	// nearest-rank percentiles
+	auto percentile = [&](const double p) {
+		const size_t rank = (size_t) (p * (double) (samples.size() - 1) + 0.5);
+		return samples.at(rank);
+	};
+
+	return {day,
+	        input,
+	        phase,
+	        samples.size(),
+	        samples.front(),
+	        percentile(0.5),
+	        total / (double) samples.size(),
+	        percentile(0.99)};
+}
+
+inline std::string
+format_ns(const double ns) {
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+
+	if (ns < 1e3) {
+		ss << ns << "ns";
+	} else if (ns < 1e6) {
+		ss << ns / 1e3 << "us";
+	} else if (ns < 1e9) {
+		ss << ns / 1e6 << "ms";
+	} else {
+		ss << ns / 1e9 << "s";
+	}
+
+	return ss.str();
+}
+
+void
+print(const stats_t &s) {
+	std::cout << std::left << std::setw(6) << s.day << std::setw(22) << s.input
+	          << std::setw(28) << s.phase << std::right << std::setw(12)
+	          << format_ns(s.median_ns) << std::setw(12) << format_ns(s.p99_ns)
+	          << std::endl;
+}
+
+void
+print_header() {
+	std::cout << std::left << std::setw(6) << "day" << std::setw(22) << "input"
+	          << std::setw(28) << "phase" << std::right << std::setw(12) << "median"
+	          << std::setw(12) << "p99" << std::endl;
+}
+
+// one record per line so results from two commits diff cleanly
+bool
+write_json(const std::string &filepath, const std::vector<stats_t> &results) {
+	std::ofstream file(filepath);
+
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(1) << "[" << std::endl;
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto &s = results.at(i);
+		file << "  {\"day\": \"" << s.day << "\", \"input\": \"" << s.input
+		     << "\", \"phase\": \"" << s.phase << "\", \"iterations\": " << s.iterations
+		     << ", \"min_ns\": " << s.min_ns << ", \"median_ns\": " << s.median_ns
+		     << ", \"mean_ns\": " << s.mean_ns << ", \"p99_ns\": " << s.p99_ns << "}"
+		     << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+	file << "]" << std::endl;
+
+	return true;
+}
+
+}   // namespace bench
@@ -0,0 +1,425 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+#include "../common/arena.hpp"
+#include "../common/cache.hpp"
+#include "../common/dispatch.hpp"
+#include "../common/input.hpp"
+#include "../day1/src/calibration.hpp"
+#include "../day3/src/adjacency.hpp"
+#include "../day3/src/bitboard.hpp"
+#include "../day3/src/incremental.hpp"
+#include "../day3/src/label_grid.hpp"
+#include "../day3/src/schematic.hpp"
+#include "../day3/src/schematic_cache.hpp"
+#include "../day3/src/streaming.hpp"
+#include "../day3/src/tiled.hpp"
+#include "../day5/src/almanac.hpp"
+#include "../day5/src/almanac_cache.hpp"
+#include "../day5/src/solve.hpp"
+#include "../day7/src/camel_cards.hpp"
+#include "../day7/src/hands_cache.hpp"
+#include "../day7/src/parser.hpp"
+#include "harness.hpp"
+
+// Benchmarks the read, parse and solve phases of each C++ day separately, on the real
+// puzzle inputs and on synthetic inputs scaled up from them.
+//
+//   bench [--iterations N] [--warmup N] [--output FILE] [day ...]
+
+typedef struct Case {
+		std::string name;
+		std::optional<std::filesystem::path> filepath;   // real inputs also time reading
+		std::string contents;
+		bool is_small;   // cheap enough for the brute force solvers
+} case_t;
+
+std::optional<std::string>
+read_contents(const std::filesystem::path &filepath) {
+	auto file = input::map_file(filepath);
+
+	if (!file.has_value()) {
+		return std::nullopt;
+	}
+
+	return std::string(file->contents());
+}
+
+// every line, k times over
+std::string
+repeat_lines(const std::string_view contents, const size_t k) {
+	std::string out;
+	out.reserve((contents.size() + 1) * k);
+
+	for (size_t i = 0; i < k; i++) {
+		for (auto line : input::lines_t{contents}) {
+			out.append(line).push_back('\n');
+		}
+	}
+
+	return out;
+}
+
+// a grid repeated k times across and k times down
+std::string
+tile_grid(const std::string_view contents, const size_t k) {
+	std::string out;
+	out.reserve((contents.size() + 1) * k * k);
+
+	for (size_t i = 0; i < k; i++) {
+		for (auto line : input::lines_t{contents}) {
+			for (size_t j = 0; j < k; j++) {
+				out.append(line);
+			}
+			out.push_back('\n');
+		}
+	}
+
+	return out;
+}
+
+// the almanac with its seeds line repeated k times
+std::string
+repeat_seeds(const std::string_view contents, const size_t k) {
+	const size_t eol = contents.find('\n');
+	const std::string_view prefix{"seeds:"};
+	const auto seeds = contents.substr(prefix.size(), eol - prefix.size());
+
+	std::string out{prefix};
+	for (size_t i = 0; i < k; i++) {
+		out.append(seeds);
+	}
+	out.append(contents.substr(eol));
+
+	return out;
+}
+
+std::vector<case_t>
+load_cases(const std::string &day, const std::vector<std::string> &files) {
+	std::vector<case_t> cases;
+
+	for (const auto &file : files) {
+		const std::filesystem::path filepath = "day" + day + "/data/" + file;
+		auto contents = read_contents(filepath);
+
+		if (!contents.has_value()) {
+			std::cout << "warning: skipping missing input " << filepath << std::endl;
+			continue;
+		}
+
+		cases.push_back({file, filepath, std::move(*contents), file == "example.in"});
+	}
+
+	return cases;
+}
+
+void
+bench_read(const std::string &day, const case_t &c, const bench::config_t &config,
+           std::vector<bench::stats_t> &results) {
+	if (!c.filepath.has_value()) {
+		return;
+	}
+
+	results.push_back(bench::measure(day, c.name, "read", config, [&]() {
+		auto file = input::map_file(*c.filepath);
+		size_t n_bytes = 0;
+		for (auto line : file->lines()) {
+			n_bytes += line.size();
+		}
+		return n_bytes;
+	}));
+}
+
+void
+bench_day1(const bench::config_t &config, std::vector<bench::stats_t> &results) {
+	auto cases = load_cases("1", {"1.in"});
+	if (!cases.empty()) {
+		cases.push_back({"1.in x100", std::nullopt, repeat_lines(cases[0].contents, 100),
+		                 false});
+	}
+
+	for (const auto &c : cases) {
+		bench_read("1", c, config, results);
+
+		const input::lines_t lines{c.contents};
+		results.push_back(bench::measure("1", c.name, "solve (part one)", config, [&]() {
+			return calibration::numeric::sum_calibration_values(lines);
+		}));
+		results.push_back(bench::measure("1", c.name, "solve (part two)", config, [&]() {
+			return calibration::spelled::sum_calibration_values(lines);
+		}));
+	}
+}
+
+// a cell and what to set it to, from a fixed-seed generator so runs are comparable
+incremental::edit_t
+random_edit(const incremental::mutable_schematic_t &schematic, uint64_t &state) {
+	constexpr std::string_view chars{"0123456789.*#+"};
+	state = state * 6364136223846793005 + 1442695040888963407;
+	const uint64_t r = state >> 11;
+
+	return {r % schematic.n_rows(), (r / schematic.n_rows()) % schematic.n_cols(),
+	        chars[(r >> 40) % chars.size()]};
+}
+
+// the running results after edits against solving the edited grid from scratch
+bool
+matches_full_solve(const incremental::mutable_schematic_t &schematic) {
+	const auto lines = schematic.lines();
+	const std::vector<std::string_view> data(lines.begin(), lines.end());
+	const auto full = label_grid::solve(*schematic::parse(data));
+
+	return full.n_engine_parts == schematic.results.n_engine_parts &&
+	       full.part_sum == schematic.results.part_sum &&
+	       full.gear_ratio_sum == schematic.results.gear_ratio_sum;
+}
+
+void
+bench_day3(const bench::config_t &config, std::vector<bench::stats_t> &results) {
+	auto cases = load_cases("3", {"3.in", "example.in"});
+	if (!cases.empty() && cases[0].name == "3.in") {
+		cases.push_back({"3.in x8x8", std::nullopt, tile_grid(cases[0].contents, 8), false});
+	}
+
+	for (const auto &c : cases) {
+		bench_read("3", c, config, results);
+
+		const input::lines_t lines{c.contents};
+		const auto data = input::collect(lines);
+		const auto parsed = schematic::parse(data);
+
+		results.push_back(bench::measure("3", c.name, "parse", config, [&]() {
+			return schematic::parse(input::collect(lines))->n_numbers();
+		}));
+		results.push_back(bench::measure("3", c.name, "parse (arena)", config, [&]() {
+			arena::arena_t arena(c.contents.size(), true);
+			return schematic::parse(input::collect(lines), arena.resource())->n_numbers();
+		}));
+		if (const uint64_t h = cache::hash(c.contents); schematic_cache::save(*parsed, h)) {
+			results.push_back(bench::measure("3", c.name, "parse (cache)", config, [&]() {
+				const auto reader =
+				    cache::open(schematic_cache::DAY, schematic_cache::VERSION,
+				                cache::hash(c.contents));
+				return schematic_cache::load(*reader, std::pmr::get_default_resource())
+				    ->n_numbers();
+			}));
+		}
+
+		// O(|N| * |S|), only practical on the real input
+		if (c.filepath.has_value()) {
+			results.push_back(bench::measure("3", c.name, "solve (naive)", config, [&]() {
+				return schematic::solve(*parsed);
+			}));
+		}
+		results.push_back(bench::measure("3", c.name, "solve (label-grid)", config,
+		                                 [&]() { return label_grid::solve(*parsed); }));
+		{
+			arena::arena_t arena(c.contents.size(), true);
+			const auto in_arena = schematic::parse(data, arena.resource());
+			results.push_back(
+			    bench::measure("3", c.name, "solve (label-grid, arena)", config,
+			                   [&]() { return label_grid::solve(*in_arena); }));
+		}
+		{
+			// built once, then every query is a walk over it
+			const auto graph = adjacency::build(*parsed);
+			results.push_back(bench::measure("3", c.name, "build (graph)", config, [&]() {
+				return adjacency::build(*parsed).n_edges();
+			}));
+			results.push_back(bench::measure("3", c.name, "solve (graph)", config, [&]() {
+				return adjacency::solve(*parsed, graph);
+			}));
+		}
+		results.push_back(bench::measure("3", c.name, "solve (bitboard)", config,
+		                                 [&]() { return bitboard::solve(data); }));
+		results.push_back(bench::measure("3", c.name, "solve (tiled)", config,
+		                                 [&]() { return tiled::solve(data); }));
+		results.push_back(bench::measure("3", c.name, "solve (stream)", config,
+		                                 [&]() { return streaming::solve(lines); }));
+		results.push_back(bench::measure("3", c.name, "solve (incremental)", config,
+		                                 [&]() { return incremental::build(data).results; }));
+		if (!data.empty()) {
+			// one grid that drifts further from the input with every edit, checked
+			// against a full solve first so a wrong answer can't pass for a fast one
+			auto editable = incremental::build(data);
+			uint64_t state = 1;
+			for (size_t i = 0; i < 1000; i++) {
+				const auto edit = random_edit(editable, state);
+				editable.apply_edit(edit.row, edit.col, edit.c);
+			}
+			if (!matches_full_solve(editable)) {
+				std::cout << "fatal: incremental results differ from a full solve "
+				          << "after edits to " << c.name << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+
+			results.push_back(
+			    bench::measure("3", c.name, "apply edit (incremental)", config, [&]() {
+				    const auto edit = random_edit(editable, state);
+				    editable.apply_edit(edit.row, edit.col, edit.c);
+				    return editable.results;
+			    }));
+		}
+	}
+}
+
+void
+bench_day5(const bench::config_t &config, std::vector<bench::stats_t> &results) {
+	auto cases = load_cases("5", {"5.in", "example.in"});
+	if (!cases.empty() && cases[0].name == "5.in") {
+		cases.push_back(
+		    {"5.in seeds x1000", std::nullopt, repeat_seeds(cases[0].contents, 1000), false});
+	}
+
+	for (const auto &c : cases) {
+		bench_read("5", c, config, results);
+
+		const input::lines_t lines{c.contents};
+		const auto data = input::collect(lines);
+		const auto maps = almanac::parse_input_almanac_maps(data);
+
+		results.push_back(bench::measure("5", c.name, "parse", config, [&]() {
+			return almanac::parse_input_almanac_maps(input::collect(lines))
+			    ->initial_seeds.size();
+		}));
+		results.push_back(bench::measure("5", c.name, "parse (arena)", config, [&]() {
+			arena::arena_t arena(c.contents.size(), true);
+			return almanac::parse_input_almanac_maps(input::collect(lines), arena.resource())
+			    ->initial_seeds.size();
+		}));
+		if (const uint64_t h = cache::hash(c.contents); almanac_cache::save(*maps, h)) {
+			results.push_back(bench::measure("5", c.name, "parse (cache)", config, [&]() {
+				const auto reader =
+				    cache::open(almanac_cache::DAY, almanac_cache::VERSION,
+				                cache::hash(c.contents));
+				return almanac_cache::load(*reader, std::pmr::get_default_resource())
+				    ->initial_seeds.size();
+			}));
+		}
+		results.push_back(bench::measure("5", c.name, "solve (part one)", config,
+		                                 [&]() { return almanac::min_location_number(*maps); }));
+
+		// part two walks every seed in every range, minutes on the real input
+		if (c.is_small) {
+			const auto seed_ranges = almanac::split_seed_ranges(*maps);
+			results.push_back(bench::measure("5", c.name, "solve (part two)", config, [&]() {
+				return almanac::min_location_number_for_seed_range(*maps, *seed_ranges);
+			}));
+		}
+	}
+}
+
+void
+bench_day7(const bench::config_t &config, std::vector<bench::stats_t> &results) {
+	auto cases = load_cases("7", {"7.in", "example.in"});
+	if (!cases.empty() && cases[0].name == "7.in") {
+		cases.push_back({"7.in x100", std::nullopt, repeat_lines(cases[0].contents, 100),
+		                 false});
+	}
+
+	for (const auto &c : cases) {
+		bench_read("7", c, config, results);
+
+		const input::lines_t lines{c.contents};
+		const auto hands = parser::parse_hands(lines);
+
+		results.push_back(bench::measure("7", c.name, "parse", config, [&]() {
+			return parser::parse_hands(lines)->size();
+		}));
+		results.push_back(bench::measure("7", c.name, "parse (arena)", config, [&]() {
+			arena::arena_t arena(c.contents.size() * 4, true);
+			return parser::parse_hands(lines, arena.resource())->size();
+		}));
+		if (const uint64_t h = cache::hash(c.contents); hands_cache::save(*hands, h)) {
+			results.push_back(bench::measure("7", c.name, "parse (cache)", config, [&]() {
+				const auto reader =
+				    cache::open(hands_cache::DAY, hands_cache::VERSION,
+				                cache::hash(c.contents));
+				return hands_cache::load(*reader, std::pmr::get_default_resource())->size();
+			}));
+		}
+		results.push_back(bench::measure("7", c.name, "solve (part one)", config, [&]() {
+			return camel_cards::calc_total_winnings_simple(*hands);
+		}));
+		results.push_back(bench::measure("7", c.name, "solve (part two)", config, [&]() {
+			return camel_cards::calc_total_winnings_complex(*hands);
+		}));
+	}
+}
+
+int
+main(int argc, char *argv[]) {
+	bench::config_t config{};
+	std::string output{"bench/build/results.json"};
+	std::vector<std::string> days;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg{argv[i]};
+
+		if (arg == "--iterations" && i + 1 < argc) {
+			config.iterations = std::stoul(argv[++i]);
+		} else if (arg == "--warmup" && i + 1 < argc) {
+			config.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--output" && i + 1 < argc) {
+			output = argv[++i];
+		} else {
+			days.push_back(arg);
+		}
+	}
+
+	if (config.iterations == 0) {
+		std::cout << "fatal: need at least one iteration" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// the "parse (cache)" rows write cache files whether or not AOC_CACHE is set, so
+	// they go to a scratch directory removed at the end
+	const auto scratch = std::filesystem::temp_directory_path() /
+	                     ("aoc-bench-" + std::to_string(getpid()));
+	cache::root() = scratch;
+
+	auto selected = [&](const std::string &day) {
+		return days.empty() || std::find(days.begin(), days.end(), day) != days.end();
+	};
+
+	std::vector<bench::stats_t> results;
+
+	if (selected("1")) {
+		bench_day1(config, results);
+	}
+	if (selected("3")) {
+		bench_day3(config, results);
+	}
+	if (selected("5")) {
+		bench_day5(config, results);
+	}
+	if (selected("7")) {
+		bench_day7(config, results);
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(scratch, error);
+
+	// which variant of each vectorised kernel was timed, see AOC_SIMD
+	std::cout << "simd: " << dispatch::name(dispatch::level()) << std::endl;
+	bench::print_header();
+	for (const auto &s : results) {
+		bench::print(s);
+	}
+
+	if (!bench::write_json(output, results)) {
+		std::cout << "fatal: can't write " << output << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << std::endl << "results written to " << output << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+// Replaces the global operator new / delete to count heap allocations, bytes allocated
+// and the live (resident) heap size and its peak. Only included through instrument.hpp
+// when TRACK_ALLOCATIONS is defined, where each INSTRUMENT_PHASE then also reports the
+// allocations made while it was running.
+//
+// The counts are process wide: a phase running alongside other threads (e.g. inside an
+// OpenMP region) also sees their allocations. The peak is kept per thread, so phases
+// on different threads (the runner's reader and solver) can't reset each other's: it
+// is the largest live heap seen by an allocation on the phase's own thread.
+//
+// This defines the replacement operators so it must only be included by one
+// translation unit, which holds for every day (and the bench) as they are single files.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace alloc_tracker {
+
+inline constinit std::atomic<uint64_t> n_allocations{0};
+inline constinit std::atomic<uint64_t> n_bytes{0};
+inline constinit std::atomic<uint64_t> live_bytes{0};
+inline constinit thread_local uint64_t peak_bytes = 0;
+
+// the instrumentation's own bookkeeping is not counted
+inline thread_local bool paused = false;
+
+typedef struct Pause {
+		const bool was_paused;
+
+		Pause() : was_paused(paused) {
+			paused = true;
+		}
+
+		~Pause() {
+			paused = was_paused;
+		}
+} pause_t;
+
+// each block is prefixed with its size so delete knows how much is being freed, 16
+// bytes keeps the user pointer aligned to alignof(std::max_align_t), over-aligned blocks
+// (aligned new, which std::pmr uses) get a header as large as their alignment
+constexpr size_t HEADER = 16;
+
+inline constexpr size_t
+header_for(const size_t alignment) {
+	return alignment > HEADER ? alignment : HEADER;
+}
+
+// kept out of line so the compiler doesn't pair the inlined malloc / free with new /
+// delete and warn about the header arithmetic
+[[gnu::noinline]] inline void *
+allocate(const size_t size, const size_t alignment = HEADER) {
+	const size_t header = header_for(alignment);
+	void *block = alignment > HEADER
+	                  ? std::aligned_alloc(alignment, (size + header + alignment - 1) /
+	                                                      alignment * alignment)
+	                  : std::malloc(size + header);
+	if (block == nullptr) {
+		return nullptr;
+	}
+
+	*(size_t *) block = size;
+
+	if (!paused) {
+		n_allocations.fetch_add(1, std::memory_order_relaxed);
+		n_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	const uint64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	if (live > peak_bytes) {
+		peak_bytes = live;
+	}
+
+	return (char *) block + header;
+}
+
+[[gnu::noinline]] inline void
+deallocate(void *p, const size_t alignment = HEADER) {
+	if (p == nullptr) {
+		return;
+	}
+
+	void *block = (char *) p - header_for(alignment);
+	live_bytes.fetch_sub(*(size_t *) block, std::memory_order_relaxed);
+	std::free(block);
+}
+
+typedef struct Snapshot {
+		uint64_t allocations;
+		uint64_t bytes;
+} snapshot_t;
+
+inline snapshot_t
+snapshot() {
+	return {n_allocations.load(std::memory_order_relaxed),
+	        n_bytes.load(std::memory_order_relaxed)};
+}
+
+// start tracking the peak of a (possibly nested) phase on this thread, returns the
+// peak so far which must be handed back to end_peak on the same thread
+inline uint64_t
+begin_peak() {
+	return std::exchange(peak_bytes, live_bytes.load(std::memory_order_relaxed));
+}
+
+// the peak live heap since the matching begin_peak, restoring the enclosing peak
+inline uint64_t
+end_peak(const uint64_t enclosing_peak) {
+	const uint64_t peak = peak_bytes;
+	if (enclosing_peak > peak) {
+		peak_bytes = enclosing_peak;
+	}
+	return peak;
+}
+
+}   // namespace alloc_tracker
+
+void *
+operator new(size_t size) {
+	void *p = alloc_tracker::allocate(size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *
+operator new[](size_t size) {
+	void *p = alloc_tracker::allocate(size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *
+operator new(size_t size, const std::nothrow_t &) noexcept {
+	return alloc_tracker::allocate(size);
+}
+
+void *
+operator new[](size_t size, const std::nothrow_t &) noexcept {
+	return alloc_tracker::allocate(size);
+}
+
+void
+operator delete(void *p) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void
+operator delete[](void *p) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void
+operator delete(void *p, size_t) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void
+operator delete[](void *p, size_t) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void
+operator delete(void *p, const std::nothrow_t &) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void
+operator delete[](void *p, const std::nothrow_t &) noexcept {
+	alloc_tracker::deallocate(p);
+}
+
+void *
+operator new(size_t size, std::align_val_t alignment) {
+	void *p = alloc_tracker::allocate(size, (size_t) alignment);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *
+operator new[](size_t size, std::align_val_t alignment) {
+	void *p = alloc_tracker::allocate(size, (size_t) alignment);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *
+operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return alloc_tracker::allocate(size, (size_t) alignment);
+}
+
+void *
+operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return alloc_tracker::allocate(size, (size_t) alignment);
+}
+
+void
+operator delete(void *p, std::align_val_t alignment) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
+
+void
+operator delete[](void *p, std::align_val_t alignment) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
+
+void
+operator delete(void *p, size_t, std::align_val_t alignment) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
+
+void
+operator delete[](void *p, size_t, std::align_val_t alignment) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
+
+void
+operator delete(void *p, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
+
+void
+operator delete[](void *p, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	alloc_tracker::deallocate(p, (size_t) alignment);
+}
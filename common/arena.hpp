@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include "pages.hpp"
+
+namespace arena {
+
+// Parsers take a std::pmr::memory_resource for everything they build, defaulting to the
+// plain heap. With AOC_ARENA set, a puzzle's parsed state goes into one monotonic buffer
+// instead: allocation is a pointer bump, the pieces sit next to each other in memory,
+// and it is all freed at once when the arena goes, nothing is freed before then.
+//
+// Either way memory comes from pages::resource(), so with AOC_HUGE_PAGES as well the
+// large blocks are backed by huge pages.
+
+inline bool
+enabled() {
+	const char *value = std::getenv("AOC_ARENA");
+	return value != nullptr && std::string_view(value) != "" &&
+	       std::string_view(value) != "0";
+}
+
+// declare before anything parsed into it, so that it outlives them
+typedef struct Arena {
+		std::optional<std::pmr::monotonic_buffer_resource> region;
+
+		// size_hint is the size of the first block, later blocks grow geometrically
+		explicit Arena(const size_t size_hint, const bool enable = enabled()) {
+			if (enable) {
+				region.emplace(std::max(size_hint, (size_t) 4096), pages::resource());
+			}
+		}
+
+		std::pmr::memory_resource *resource() {
+			return region.has_value() ? &*region : pages::resource();
+		}
+} arena_t;
+
+}   // namespace arena
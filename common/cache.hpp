@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "input.hpp"
+#include "instrument.hpp"
+
+namespace cache {
+
+// A day's parsed representation as a binary file, so that a later run on the same input
+// maps it and copies the arrays out instead of parsing the text again.
+//
+// Files are keyed by a hash of the input contents, so an edited input simply misses,
+// and carry the day's version (VERSION next to DAY in its *_cache.hpp), which is bumped
+// whenever that day's layout changes, so stale files are ignored rather than misread.
+// Layout:
+//
+//   header_t
+//   section_t × n_sections     where each array is, relative to the start of the file
+//   arrays, each 8 byte aligned
+//
+// Everything is in native byte order, a cache is not meant to move between machines.
+//
+// Off unless AOC_CACHE is set, files go in dayN/build/cache/ under root().
+
+constexpr char MAGIC[8] = {'A', 'O', 'C', 'C', 'A', 'C', 'H', 'E'};
+
+typedef struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t day;
+		uint64_t input_hash;
+		uint64_t n_sections;
+} header_t;
+
+typedef struct Section {
+		uint64_t offset;
+		uint64_t count;
+		uint64_t element_size;
+} section_t;
+
+inline bool
+enabled() {
+	const char *value = std::getenv("AOC_CACHE");
+	return value != nullptr && std::string_view(value) != "" &&
+	       std::string_view(value) != "0";
+}
+
+// 64 bit FNV-1a taken 8 bytes at a time rather than 1 (hashing is most of the cost of
+// a cache hit), not cryptographic, only to tell inputs apart
+inline uint64_t
+hash(const std::string_view contents) {
+	constexpr uint64_t PRIME = 0x100000001b3;
+	uint64_t h = 0xcbf29ce484222325 ^ contents.size();
+
+	size_t i = 0;
+	for (; i + 8 <= contents.size(); i += 8) {
+		uint64_t word;
+		std::memcpy(&word, contents.data() + i, sizeof(word));
+		h = (h ^ word) * PRIME;
+		h ^= h >> 29;
+	}
+	for (; i < contents.size(); i++) {
+		h = (h ^ (uint8_t) contents[i]) * PRIME;
+	}
+
+	return h;
+}
+
+// the working directory (the repo root) unless changed, e.g. by the bench so its
+// files don't land in the source tree
+inline std::filesystem::path &
+root() {
+	static std::filesystem::path directory{};
+	return directory;
+}
+
+inline std::filesystem::path
+path_for(const uint32_t day, const uint64_t input_hash) {
+	std::ostringstream name;
+	name << std::hex << std::setw(16) << std::setfill('0') << input_hash << ".bin";
+	return root() / ("day" + std::to_string(day)) / "build" / "cache" / name.str();
+}
+
+inline size_t
+align_up(const size_t n) {
+	return (n + 7) & ~(size_t) 7;
+}
+
+// collects arrays in order, then writes them out in one go
+typedef struct Writer {
+		std::vector<section_t> sections;
+		std::vector<std::string_view> arrays;
+
+		template <typename T>
+		void add(const std::span<const T> array) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			sections.push_back({0, array.size(), sizeof(T)});
+			arrays.push_back({(const char *) array.data(), array.size_bytes()});
+		}
+
+		// written to a temporary file and renamed into place so a reader never sees a
+		// partial file
+		bool write(const uint32_t day, const uint32_t version,
+		           const uint64_t input_hash) {
+			INSTRUMENT_PHASE("cache (write)");
+
+			const auto path = path_for(day, input_hash);
+			std::error_code error;
+			std::filesystem::create_directories(path.parent_path(), error);
+			if (error) {
+				return false;
+			}
+
+			header_t header{};
+			std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			header.version = version;
+			header.day = day;
+			header.input_hash = input_hash;
+			header.n_sections = sections.size();
+
+			size_t offset =
+			    align_up(sizeof(header_t) + sizeof(section_t) * sections.size());
+			for (size_t i = 0; i < sections.size(); i++) {
+				sections[i].offset = offset;
+				offset = align_up(offset + arrays[i].size());
+			}
+
+			auto tmp = path;
+			tmp += ".tmp";
+			{
+				std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+				if (!file.is_open()) {
+					return false;
+				}
+
+				const char padding[8] = {};
+				auto pad_to = [&](const size_t position) {
+					const auto n = position - (size_t) file.tellp();
+					file.write(padding, (std::streamsize) n);
+				};
+
+				file.write((const char *) &header, sizeof(header));
+				file.write((const char *) sections.data(),
+				           (std::streamsize) (sizeof(section_t) * sections.size()));
+				for (size_t i = 0; i < sections.size(); i++) {
+					pad_to(sections[i].offset);
+					file.write(arrays[i].data(), (std::streamsize) arrays[i].size());
+				}
+
+				if (!file.good()) {
+					return false;
+				}
+			}
+
+			std::filesystem::rename(tmp, path, error);
+			return !error;
+		}
+} writer_t;
+
+typedef struct Reader {
+		input::mapped_file_t file;
+
+		const header_t &header() const {
+			return *(const header_t *) file.data;
+		}
+
+		// empty if the section isn't an array of T
+		template <typename T>
+		std::optional<std::span<const T>> array(const size_t i) const {
+			if (i >= header().n_sections) {
+				return std::nullopt;
+			}
+
+			const auto *sections = (const section_t *) (file.data + sizeof(header_t));
+			const auto &section = sections[i];
+			if (section.element_size != sizeof(T)) {
+				return std::nullopt;
+			}
+
+			return std::span<const T>((const T *) (file.data + section.offset),
+			                          section.count);
+		}
+
+		// replace the contents of out with section i, false if it isn't an array of T
+		template <typename T, typename C>
+		bool copy_to(const size_t i, C &out) const {
+			const auto a = array<T>(i);
+			if (!a.has_value()) {
+				return false;
+			}
+			out.assign(a->begin(), a->end());
+			return true;
+		}
+} reader_t;
+
+// the cache for this input, if there is a valid one
+inline std::optional<reader_t>
+open(const uint32_t day, const uint32_t version, const uint64_t input_hash) {
+	INSTRUMENT_PHASE("cache (read)");
+
+	auto file = input::map_file(path_for(day, input_hash));
+	if (!file.has_value() || file->size < sizeof(header_t)) {
+		return std::nullopt;
+	}
+
+	const auto &header = *(const header_t *) file->data;
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+	    header.version != version || header.day != day ||
+	    header.input_hash != input_hash) {
+		return std::nullopt;
+	}
+
+	// every section must lie inside the file and be aligned for its elements
+	const size_t table_end = sizeof(header_t) + sizeof(section_t) * header.n_sections;
+	if (header.n_sections > file->size || table_end > file->size) {
+		return std::nullopt;
+	}
+
+	const auto *sections = (const section_t *) (file->data + sizeof(header_t));
+	for (size_t i = 0; i < header.n_sections; i++) {
+		const auto &s = sections[i];
+		if (s.offset % 8 != 0 || s.offset < table_end || s.offset > file->size ||
+		    s.element_size == 0 || s.count > (file->size - s.offset) / s.element_size) {
+			return std::nullopt;
+		}
+	}
+
+	return reader_t{std::move(*file)};
+}
+
+}   // namespace cache
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cpuid.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace dispatch {
+
+// The builds target plain x86-64, so anything wider than SSE2 has to be chosen at run
+// time. A hot kernel is written once per instruction set level, each variant compiled
+// for its level with [[gnu::target(...)]] (the TARGET_* macros below), and select()
+// hands back the best one this CPU supports, found once with cpuid.
+//
+// AOC_SIMD=scalar|sse4.2|avx2|avx512 caps the level, to benchmark one variant against
+// another on the same machine. Asking for more than the CPU has falls back to what it
+// does have, with a warning.
+
+enum class level_t : int { scalar, sse42, avx2, avx512 };
+
+#define TARGET_SSE42 [[gnu::target("sse4.2,popcnt")]]
+#define TARGET_AVX2 [[gnu::target("avx2,bmi,bmi2,popcnt")]]
+#define TARGET_AVX512 [[gnu::target("avx512f,avx512bw,avx512vl,avx2,bmi,bmi2,popcnt")]]
+
+// for kernels working 64 bytes at a time with full width loads: a short tail of n bytes
+// is copied out to a zeroed block so nothing past the end of p is read, the kernel must
+// treat zero bytes as nothing
+inline const char *
+padded(const char *p, const size_t n, char (&block)[64]) {
+	if (n == 64) {
+		return p;
+	}
+	std::memset(block, 0, sizeof(block));
+	std::memcpy(block, p, n);
+	return block;
+}
+
+inline const char *
+name(const level_t level) {
+	switch (level) {
+	case level_t::sse42:
+		return "sse4.2";
+	case level_t::avx2:
+		return "avx2";
+	case level_t::avx512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
+
+// the best level both the CPU and the OS (which must save the wider registers on a
+// context switch, see XCR0) support
+inline level_t
+supported() {
+	unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return level_t::scalar;
+	}
+
+	const bool has_sse42 = ecx & bit_SSE4_2;
+	const bool has_osxsave = ecx & bit_OSXSAVE;
+	if (!has_sse42) {
+		return level_t::scalar;
+	}
+	if (!has_osxsave) {
+		return level_t::sse42;
+	}
+
+	uint32_t xcr0_lo = 0, xcr0_hi = 0;
+	__asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	const uint64_t xcr0 = ((uint64_t) xcr0_hi << 32) | xcr0_lo;
+	const bool os_avx = (xcr0 & 0x06) == 0x06;      // xmm, ymm
+	const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;   // and opmask, zmm
+
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		return level_t::sse42;
+	}
+
+	const bool has_avx2 = (ebx & bit_AVX2) && (ebx & bit_BMI) && (ebx & bit_BMI2);
+	const bool has_avx512 =
+	    (ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512VL);
+
+	if (has_avx2 && has_avx512 && os_avx512) {
+		return level_t::avx512;
+	}
+	if (has_avx2 && os_avx) {
+		return level_t::avx2;
+	}
+	return level_t::sse42;
+}
+
+// the level asked for with AOC_SIMD, or the highest if it isn't set
+inline level_t
+requested() {
+	const char *value = std::getenv("AOC_SIMD");
+	if (value == nullptr || std::string_view(value) == "") {
+		return level_t::avx512;
+	}
+
+	for (int l = (int) level_t::scalar; l <= (int) level_t::avx512; l++) {
+		if (std::string_view(value) == name((level_t) l)) {
+			return (level_t) l;
+		}
+	}
+
+	std::cerr << "warning: unknown AOC_SIMD=" << value << ", expected one of scalar, "
+	          << "sse4.2, avx2, avx512" << std::endl;
+	return level_t::avx512;
+}
+
+// worked out on first use, then fixed for the process
+inline level_t
+level() {
+	static const level_t chosen = []() {
+		const auto cpu = supported();
+		const auto asked = requested();
+
+		const char *value = std::getenv("AOC_SIMD");
+		if (value != nullptr && std::string_view(value) == name(asked) && asked > cpu) {
+			std::cerr << "warning: AOC_SIMD=" << value
+			          << " isn't supported here, using " << name(cpu) << std::endl;
+		}
+
+		return asked < cpu ? asked : cpu;
+	}();
+
+	return chosen;
+}
+
+// the variant for level(), or the next one down where a kernel has no variant for it
+// (nullptr), scalar must always be given
+template <typename F>
+F
+select(F scalar, F sse42, F avx2, F avx512) {
+	const F by_level[] = {scalar, sse42, avx2, avx512};
+
+	for (int l = (int) level(); l > 0; l--) {
+		if (by_level[l] != nullptr) {
+			return by_level[l];
+		}
+	}
+	return scalar;
+}
+
+}   // namespace dispatch
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "instrument.hpp"
+
+namespace input {
+
+// Shared input layer for the C++ days. The file is mmap'd read-only (with a sequential
+// access hint) and handed out as std::string_view lines pointing into the mapping, so
+// reading an input costs no per-line copies or heap allocations. Views are only valid
+// while the mapped_file_t they came from is alive.
+
+// Lazy range over the lines of a buffer, split on '\n' like std::getline (a trailing
+// newline does not produce an empty last line)
+typedef struct Lines {
+		std::string_view buffer;
+
+		struct iterator {
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = std::string_view;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const std::string_view *;
+				using reference = std::string_view;
+
+				std::string_view rest;
+				std::string_view line;
+				bool done = true;
+
+				iterator() = default;
+
+				explicit iterator(const std::string_view buffer) : rest(buffer), done(false) {
+					next();
+				};
+
+				inline void next() {
+					if (rest.empty()) {
+						done = true;
+						return;
+					}
+
+					const size_t end = rest.find('\n');
+					line = rest.substr(0, end);
+					rest = end == std::string_view::npos ? std::string_view{}
+					                                     : rest.substr(end + 1);
+				};
+
+				inline std::string_view operator*() const {
+					return line;
+				};
+
+				inline iterator &operator++() {
+					next();
+					return *this;
+				};
+
+				inline iterator operator++(int) {
+					auto copy = *this;
+					next();
+					return copy;
+				};
+
+				inline bool operator==(const iterator &other) const {
+					return done == other.done && (done || line.data() == other.line.data());
+				};
+		};
+
+		inline iterator begin() const {
+			return iterator(buffer);
+		};
+
+		inline iterator end() const {
+			return iterator();
+		};
+} lines_t;
+
+typedef struct MappedFile {
+		const char *data = nullptr;
+		size_t size = 0;
+
+		MappedFile() = default;
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		MappedFile(MappedFile &&other) noexcept
+		    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {
+		}
+
+		MappedFile &operator=(MappedFile &&other) noexcept {
+			std::swap(data, other.data);
+			std::swap(size, other.size);
+			return *this;
+		}
+
+		~MappedFile() {
+			if (data != nullptr && size > 0) {
+				munmap((void *) data, size);
+			}
+		}
+
+		inline std::string_view contents() const {
+			return {data, size};
+		};
+
+		inline lines_t lines() const {
+			return {contents()};
+		};
+} mapped_file_t;
+
+std::optional<mapped_file_t>
+map_file(const std::filesystem::path &filepath) {
+	INSTRUMENT_PHASE("read");
+
+	const int fd = open(filepath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return std::nullopt;
+	}
+
+	mapped_file_t file;
+	file.size = (size_t) st.st_size;
+
+	if (file.size > 0) {
+		void *addr = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			close(fd);
+			return std::nullopt;
+		}
+
+		madvise(addr, file.size, MADV_SEQUENTIAL);
+		file.data = (const char *) addr;
+	}
+
+	// the mapping stays valid once the descriptor is closed
+	close(fd);
+
+	return file;
+}
+
+// for the days which need random access to their lines, one allocation for the
+// vector of views rather than one per line
+std::vector<std::string_view>
+collect(const lines_t &lines) {
+	std::vector<std::string_view> v;
+	for (auto line : lines) {
+		v.push_back(line);
+	}
+	return v;
+}
+
+}   // namespace input
@@ -0,0 +1,309 @@
+#pragma once
+
+// Per-phase timers and named counters for the C++ days.
+//
+//   INSTRUMENT_PHASE("parse");                 // times the rest of the enclosing scope
+//   INSTRUMENT_COUNT("lines parsed", n);       // adds n to a named counter
+//
+// Both compile to nothing unless INSTRUMENT is defined (./run defines it when
+// AOC_INSTRUMENT is set). When compiled in and AOC_INSTRUMENT is set at runtime, the
+// totals are written as JSON at exit: to stderr if AOC_INSTRUMENT is "1" or "-",
+// otherwise to the file it names.
+//
+// Defining TRACK_ALLOCATIONS as well (AOC_TRACK_ALLOCATIONS for ./run) hooks operator
+// new / delete (see alloc_tracker.hpp) so every phase also reports its allocation
+// count, bytes allocated and peak live heap, and enables
+//
+//   INSTRUMENT_NO_ALLOCATIONS("solve loop");   // count allocations in the rest of scope
+//
+// which reports any allocations made in a scope expected to be allocation free under
+// the counter "allocations in <name>".
+//
+// Defining PERF_COUNTERS (AOC_PERF_COUNTERS for ./run) adds the hardware counters from
+// perf_counters.hpp to every phase: cycles, instructions (and so IPC), L1 and LLC
+// misses and branch misses.
+
+#if (defined(TRACK_ALLOCATIONS) || defined(PERF_COUNTERS)) && !defined(INSTRUMENT)
+#define INSTRUMENT
+#endif
+
+#ifdef INSTRUMENT
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#ifdef TRACK_ALLOCATIONS
+#include "alloc_tracker.hpp"
+#endif
+
+#ifdef PERF_COUNTERS
+#include "perf_counters.hpp"
+#endif
+
+namespace instrument {
+
+#ifdef TRACK_ALLOCATIONS
+typedef alloc_tracker::pause_t pause_t;
+#else
+typedef struct Pause {
+		// user provided so an unused pause doesn't warn
+		Pause() {
+		}
+} pause_t;
+#endif
+
+typedef struct Phase {
+		const std::string name;
+		std::atomic<uint64_t> calls{0};
+		std::atomic<uint64_t> total_ns{0};
+		std::atomic<uint64_t> allocations{0};
+		std::atomic<uint64_t> bytes{0};
+		std::atomic<uint64_t> peak_bytes{0};   // largest live heap over any one call
+#ifdef PERF_COUNTERS
+		std::array<std::atomic<uint64_t>, perf_counters::events.size()> hardware{};
+#endif
+
+		explicit Phase(const std::string_view name) : name(name) {
+		}
+} phase_t;
+
+// Each thread counting at a given call site gets its own slot, so the hot path is an
+// uncontended add with no lock prefix, slots are only summed when reporting. Slots are
+// owned here (not by the thread) so they outlive OpenMP's worker threads.
+typedef struct Counter {
+		const std::string name;
+		std::mutex mutex;
+		std::deque<std::atomic<uint64_t>> slots;
+
+		explicit Counter(const std::string_view name) : name(name) {
+		}
+
+		std::atomic<uint64_t> *slot() {
+			pause_t pause;
+			std::lock_guard lock(mutex);
+			return &slots.emplace_back(0);
+		}
+
+		uint64_t total() {
+			pause_t pause;
+			std::lock_guard lock(mutex);
+			uint64_t sum = 0;
+			for (const auto &s : slots) {
+				sum += s.load(std::memory_order_relaxed);
+			}
+			return sum;
+		}
+} counter_t;
+
+typedef struct Registry {
+		std::mutex mutex;
+		std::deque<phase_t> phases;
+		std::deque<counter_t> counters;
+
+		~Registry() {
+			pause_t pause;
+			const char *target = std::getenv("AOC_INSTRUMENT");
+			if (target == nullptr) {
+				return;
+			}
+
+			const std::string path{target};
+			if (path.empty() || path == "1" || path == "-") {
+				write_json(std::cerr);
+			} else {
+				std::ofstream file(path);
+				write_json(file);
+			}
+		}
+
+		void write_json(std::ostream &out) {
+			std::lock_guard lock(mutex);
+
+			out << "{" << std::endl << "  \"phases\": [" << std::endl;
+			for (size_t i = 0; i < phases.size(); i++) {
+				auto &p = phases.at(i);
+				out << "    {\"name\": \"" << p.name << "\", \"calls\": " << p.calls
+				    << ", \"total_ns\": " << p.total_ns;
+#ifdef TRACK_ALLOCATIONS
+				out << ", \"allocations\": " << p.allocations << ", \"bytes\": " << p.bytes
+				    << ", \"peak_bytes\": " << p.peak_bytes;
+#endif
+#ifdef PERF_COUNTERS
+				for (size_t e = 0; e < perf_counters::events.size(); e++) {
+					out << ", \"" << perf_counters::events[e].name << "\": " << p.hardware[e];
+				}
+				const uint64_t cycles = p.hardware[0];
+				out << ", \"ipc\": "
+				    << (cycles == 0 ? 0.0 : (double) p.hardware[1] / (double) cycles);
+#endif
+				out << "}" << (i + 1 < phases.size() ? "," : "") << std::endl;
+			}
+			out << "  ]," << std::endl << "  \"counters\": [" << std::endl;
+			for (size_t i = 0; i < counters.size(); i++) {
+				auto &c = counters.at(i);
+				out << "    {\"name\": \"" << c.name << "\", \"value\": " << c.total() << "}"
+				    << (i + 1 < counters.size() ? "," : "") << std::endl;
+			}
+			out << "  ]" << std::endl << "}" << std::endl;
+		}
+} registry_t;
+
+inline registry_t &
+registry() {
+	static registry_t r;
+	return r;
+}
+
+// phases and counters are looked up by name once per call site, see the macros. Names
+// are taken as views so nothing is allocated outside the pause.
+inline phase_t &
+phase(const std::string_view name) {
+	pause_t pause;
+	auto &r = registry();
+	std::lock_guard lock(r.mutex);
+
+	for (auto &p : r.phases) {
+		if (p.name == name) {
+			return p;
+		}
+	}
+	return r.phases.emplace_back(name);
+}
+
+inline counter_t &
+counter(const std::string_view name) {
+	pause_t pause;
+	auto &r = registry();
+	std::lock_guard lock(r.mutex);
+
+	for (auto &c : r.counters) {
+		if (c.name == name) {
+			return c;
+		}
+	}
+	return r.counters.emplace_back(name);
+}
+
+typedef struct ScopedTimer {
+		phase_t &phase;
+#ifdef TRACK_ALLOCATIONS
+		const alloc_tracker::snapshot_t allocations;
+		const uint64_t enclosing_peak;
+#endif
+#ifdef PERF_COUNTERS
+		const perf_counters::values_t hardware;
+#endif
+		const std::chrono::steady_clock::time_point start;
+
+		explicit ScopedTimer(phase_t &phase)
+		    : phase(phase),
+#ifdef TRACK_ALLOCATIONS
+		      allocations(alloc_tracker::snapshot()),
+		      enclosing_peak(alloc_tracker::begin_peak()),
+#endif
+#ifdef PERF_COUNTERS
+		      hardware(perf_counters::read()),
+#endif
+		      start(std::chrono::steady_clock::now()) {
+		}
+
+		~ScopedTimer() {
+			const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			                    std::chrono::steady_clock::now() - start)
+			                    .count();
+
+#ifdef PERF_COUNTERS
+			const auto end_hardware = perf_counters::read();
+			for (size_t e = 0; e < hardware.size(); e++) {
+				phase.hardware[e].fetch_add(end_hardware[e] - hardware[e],
+				                            std::memory_order_relaxed);
+			}
+#endif
+
+			phase.calls.fetch_add(1, std::memory_order_relaxed);
+			phase.total_ns.fetch_add((uint64_t) ns, std::memory_order_relaxed);
+
+#ifdef TRACK_ALLOCATIONS
+			const auto end = alloc_tracker::snapshot();
+			phase.allocations.fetch_add(end.allocations - allocations.allocations,
+			                            std::memory_order_relaxed);
+			phase.bytes.fetch_add(end.bytes - allocations.bytes, std::memory_order_relaxed);
+
+			const uint64_t peak = alloc_tracker::end_peak(enclosing_peak);
+			uint64_t current = phase.peak_bytes.load(std::memory_order_relaxed);
+			while (peak > current && !phase.peak_bytes.compare_exchange_weak(
+			                             current, peak, std::memory_order_relaxed)) {
+			}
+#endif
+		}
+} scoped_timer_t;
+
+inline void
+add(std::atomic<uint64_t> *slot, const uint64_t n) {
+	// only this thread writes to the slot
+	slot->store(slot->load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#ifdef TRACK_ALLOCATIONS
+typedef struct NoAllocations {
+		counter_t &counter;
+		const uint64_t start;
+
+		explicit NoAllocations(counter_t &counter)
+		    : counter(counter), start(alloc_tracker::snapshot().allocations) {
+		}
+
+		~NoAllocations() {
+			const uint64_t n = alloc_tracker::snapshot().allocations - start;
+			if (n > 0) {
+				thread_local std::atomic<uint64_t> *slot = counter.slot();
+				add(slot, n);
+			}
+		}
+} no_allocations_t;
+#endif
+
+}   // namespace instrument
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b)  INSTRUMENT_CONCAT_(a, b)
+
+#define INSTRUMENT_PHASE(name)                                                          \
+	static instrument::phase_t &INSTRUMENT_CONCAT(instrument_phase_, __LINE__) =        \
+	    instrument::phase(name);                                                        \
+	instrument::scoped_timer_t INSTRUMENT_CONCAT(instrument_timer_, __LINE__)(          \
+	    INSTRUMENT_CONCAT(instrument_phase_, __LINE__))
+
+#define INSTRUMENT_COUNT(name, n)                                                       \
+	do {                                                                                \
+		static instrument::counter_t &instrument_counter = instrument::counter(name);   \
+		thread_local std::atomic<uint64_t> *instrument_slot = instrument_counter.slot(); \
+		instrument::add(instrument_slot, (uint64_t) (n));                               \
+	} while (0)
+
+#ifdef TRACK_ALLOCATIONS
+#define INSTRUMENT_NO_ALLOCATIONS(name)                                                 \
+	static instrument::counter_t &INSTRUMENT_CONCAT(instrument_counter_, __LINE__) =    \
+	    instrument::counter("allocations in " name);                                   \
+	instrument::no_allocations_t INSTRUMENT_CONCAT(instrument_guard_, __LINE__)(        \
+	    INSTRUMENT_CONCAT(instrument_counter_, __LINE__))
+#else
+#define INSTRUMENT_NO_ALLOCATIONS(name) ((void) 0)
+#endif
+
+#else
+
+#define INSTRUMENT_PHASE(name)          ((void) 0)
+#define INSTRUMENT_COUNT(name, n)       ((void) 0)
+#define INSTRUMENT_NO_ALLOCATIONS(name) ((void) 0)
+
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <linux/mempolicy.h>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "instrument.hpp"
+
+namespace pages {
+
+// The big flat arrays (dense grids over the whole schematic, parsed puzzles grown large)
+// are read all over, and at 4K pages they need far more TLB entries than there are.
+// With AOC_HUGE_PAGES set every allocation of at least a huge page is mapped on its own
+// and madvise'd MADV_HUGEPAGE, so the kernel backs it with 2M pages: 512 times fewer
+// translations. Smaller allocations couldn't fill a huge page anyway and go to the heap
+// as usual. This works whether transparent huge pages are "always" or "madvise".
+//
+// AOC_NUMA picks where those pages live on a machine with several nodes:
+//   interleave    spread round robin over every node, for arrays every thread reads
+//   first-touch   on the node of the thread that first writes each page, for arrays
+//                 built and used by the same thread (e.g. each tile of the tiled engine)
+// otherwise the process's policy applies, normally first touch too.
+//
+// Pages mapped here bypass operator new, so the allocation tracker doesn't see them;
+// the "huge page bytes" counter does.
+
+constexpr size_t HUGE_PAGE_SIZE = (size_t) 2 << 20;
+
+enum class numa_t { inherit, interleave, first_touch };
+
+inline bool
+enabled() {
+	const char *value = std::getenv("AOC_HUGE_PAGES");
+	return value != nullptr && std::string_view(value) != "" &&
+	       std::string_view(value) != "0";
+}
+
+inline numa_t
+numa_policy() {
+	const char *value = std::getenv("AOC_NUMA");
+	if (value == nullptr) {
+		return numa_t::inherit;
+	}
+
+	const std::string_view policy{value};
+	if (policy == "interleave") {
+		return numa_t::interleave;
+	}
+	if (policy == "first-touch") {
+		return numa_t::first_touch;
+	}
+	return numa_t::inherit;
+}
+
+inline size_t
+round_up(const size_t n) {
+	return (n + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+// once per process, a failure here only costs performance. Allocations can come from
+// concurrent tasks (the tiled engine's label grids), hence the atomic.
+inline void
+warn_once(const char *what) {
+	static std::atomic<bool> warned{false};
+	if (!warned.exchange(true)) {
+		std::cerr << "warning: " << what << " failed, continuing without it"
+		          << std::endl;
+	}
+}
+
+// mbind through the raw syscall, so as not to need libnuma
+inline void
+apply_numa_policy(void *p, const size_t size, const numa_t numa) {
+	if (numa == numa_t::inherit) {
+		return;
+	}
+
+	long result = 0;
+	if (numa == numa_t::interleave) {
+		// over every node this process may allocate on
+		constexpr size_t max_nodes = 1024;
+		unsigned long nodes[max_nodes / (8 * sizeof(unsigned long))] = {};
+
+		result = syscall(SYS_get_mempolicy, nullptr, nodes, max_nodes, nullptr,
+		                 MPOL_F_MEMS_ALLOWED);
+		if (result == 0) {
+			result = syscall(SYS_mbind, p, size, MPOL_INTERLEAVE, nodes, max_nodes, 0);
+		}
+	} else {
+		result = syscall(SYS_mbind, p, size, MPOL_LOCAL, nullptr, 0, 0);
+	}
+
+	if (result != 0) {
+		warn_once("mbind");
+	}
+}
+
+typedef struct HugePageResource : std::pmr::memory_resource {
+		const numa_t numa;
+		std::pmr::memory_resource *const upstream;
+
+		explicit HugePageResource(
+		    const numa_t numa = numa_policy(),
+		    std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+		    : numa(numa), upstream(upstream) {
+		}
+
+	protected:
+		void *do_allocate(const size_t bytes, const size_t alignment) override {
+			if (bytes < HUGE_PAGE_SIZE || alignment > HUGE_PAGE_SIZE) {
+				return upstream->allocate(bytes, alignment);
+			}
+
+			// over-map by a huge page then trim, so the region starts on a 2M boundary
+			// and every page of it can be a huge one
+			const size_t size = round_up(bytes);
+			void *mapped = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+			                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mapped == MAP_FAILED) {
+				throw std::bad_alloc();
+			}
+
+			const uintptr_t start = (uintptr_t) mapped;
+			const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+			if (aligned > start) {
+				munmap(mapped, aligned - start);
+			}
+			if (const size_t tail = start + HUGE_PAGE_SIZE - aligned; tail > 0) {
+				munmap((void *) (aligned + size), tail);
+			}
+
+			void *p = (void *) aligned;
+			if (madvise(p, size, MADV_HUGEPAGE) != 0) {
+				warn_once("madvise(MADV_HUGEPAGE)");
+			}
+			apply_numa_policy(p, size, numa);
+
+			INSTRUMENT_COUNT("huge page bytes", size);
+
+			return p;
+		}
+
+		void do_deallocate(void *p, const size_t bytes, const size_t alignment) override {
+			if (bytes < HUGE_PAGE_SIZE || alignment > HUGE_PAGE_SIZE) {
+				upstream->deallocate(p, bytes, alignment);
+				return;
+			}
+			munmap(p, round_up(bytes));
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+			return this == &other;
+		}
+} huge_page_resource_t;
+
+// for the large arrays: huge pages with AOC_HUGE_PAGES set, otherwise the default heap
+inline std::pmr::memory_resource *
+resource() {
+	static huge_page_resource_t huge;
+	static std::pmr::memory_resource *const chosen =
+	    enabled() ? &huge : std::pmr::get_default_resource();
+	return chosen;
+}
+
+}   // namespace pages
@@ -0,0 +1,161 @@
+#pragma once
+
+// Hardware performance counters for the calling thread through Linux perf_event_open:
+// cycles, instructions, L1 data cache read misses, last level cache misses, branch
+// misses and data TLB read misses. Only included through instrument.hpp when
+// PERF_COUNTERS is defined, where each INSTRUMENT_PHASE then also reports the counts
+// taken while it was running.
+//
+// The counters follow one thread, so a phase wrapping an OpenMP region only sees the
+// thread that entered it, phase the loop body to count the workers too. Opening them
+// needs perf_event_paranoid <= 2 (user space only) and a PMU the kernel exposes, most
+// VMs and containers have neither, in which case every count reads as zero and a
+// warning is printed once. The same goes for a group that opens but is never scheduled
+// because the PMU hasn't that many counters free (six events can be too many on Intel
+// with the NMI watchdog holding one).
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace perf_counters {
+
+typedef struct Event {
+		const char *name;
+		uint32_t type;
+		uint64_t config;
+} event_t;
+
+constexpr uint64_t
+cache_event(const uint64_t cache, const uint64_t op, const uint64_t result) {
+	return cache | (op << 8) | (result << 16);
+}
+
+// cycles leads the group, every event is scheduled onto the PMU together with it
+constexpr std::array<event_t, 6> events{{
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses", PERF_TYPE_HW_CACHE,
+     cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                 PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"dtlb_misses", PERF_TYPE_HW_CACHE,
+     cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                 PERF_COUNT_HW_CACHE_RESULT_MISS)},
+}};
+
+typedef std::array<uint64_t, events.size()> values_t;
+
+typedef struct Group {
+		std::array<int, events.size()> fds;
+		bool is_open = false;
+
+		Group() {
+			fds.fill(-1);
+
+			for (size_t i = 0; i < events.size(); i++) {
+				perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = events[i].type;
+				attr.config = events[i].config;
+				attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+				                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+
+				// this thread, any cpu
+				fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1,
+				                       i == 0 ? -1 : fds[0], 0);
+				if (fds[i] < 0) {
+					warn_once(events[i].name);
+					close_all();
+					return;
+				}
+			}
+
+			is_open = true;
+		}
+
+		~Group() {
+			close_all();
+		}
+
+		Group(const Group &) = delete;
+		Group &operator=(const Group &) = delete;
+
+		void close_all() {
+			for (auto &fd : fds) {
+				if (fd >= 0) {
+					close(fd);
+					fd = -1;
+				}
+			}
+		}
+
+		static void warn_once(const char *name) {
+			static std::atomic<bool> warned{false};
+			if (!warned.exchange(true)) {
+				std::cerr << "warning: can't open perf counter " << name << " ("
+				          << std::strerror(errno) << "), hardware counts will read as 0"
+				          << std::endl;
+			}
+		}
+
+		static void warn_never_scheduled() {
+			static std::atomic<bool> warned{false};
+			if (!warned.exchange(true)) {
+				std::cerr << "warning: perf counters were never scheduled ("
+				          << events.size() << " events may be more than the PMU has "
+				          << "free), hardware counts will read as 0" << std::endl;
+			}
+		}
+
+		// counts so far, scaled up if the kernel had to multiplex the group
+		values_t read_values() const {
+			values_t values{};
+			if (!is_open) {
+				return values;
+			}
+
+			struct {
+					uint64_t n;
+					uint64_t time_enabled;
+					uint64_t time_running;
+					uint64_t values[events.size()];
+			} data;
+
+			if (::read(fds[0], &data, sizeof(data)) != (ssize_t) sizeof(data)) {
+				return values;
+			}
+			if (data.time_running == 0) {
+				// enabled for a while without ever getting onto the PMU
+				if (data.time_enabled > 0) {
+					warn_never_scheduled();
+				}
+				return values;
+			}
+
+			const double scale = (double) data.time_enabled / (double) data.time_running;
+			for (size_t i = 0; i < events.size(); i++) {
+				values[i] = (uint64_t) ((double) data.values[i] * scale);
+			}
+			return values;
+		}
+} group_t;
+
+// opened on first use by each thread, counting from then on
+inline values_t
+read() {
+	thread_local group_t group;
+	return group.read_values();
+}
+
+}   // namespace perf_counters
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <omp.h>
+
+namespace pool {
+
+// Parallel loops are written as `omp taskloop` inside pool::run rather than `omp
+// parallel for`, so that everything running in one process shares one team of OpenMP
+// threads. Run on its own, a day starts the team here. Run as a task of the runner
+// (which already has the team), its loop's tasks join the same queue as every other
+// day's and idle threads steal them, rather than each day starting a nested team or
+// running serially.
+template <typename F>
+void
+run(F &&f) {
+	if (omp_in_parallel()) {
+		f();
+		return;
+	}
+
+#pragma omp parallel
+#pragma omp single
+	f();
+}
+
+}   // namespace pool
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace scan {
+
+// Allocation-free unsigned integer parsing shared by the C++ days, in place of
+// istringstream / stringstream / atoi. Runs of 8 or more digits are consumed 8 at a
+// time with SWAR (SIMD within a register) arithmetic on one 64 bit load, whatever is
+// left is handed to std::from_chars.
+//
+// Values are 64 bit: any run of up to 19 digits is exact, a longer run may not fit and
+// then wraps (mod 2^64) rather than failing. Its end is still found correctly, so a
+// caller only gets the value wrong, never the extent. The puzzles never get close.
+
+constexpr uint64_t powers_of_ten[] = {1,      10,      100,      1000,      10000,
+                                      100000, 1000000, 10000000, 100000000};
+
+// true if all 8 bytes are '0'..'9' (as a little endian word)
+inline bool
+is_eight_digits(const uint64_t word) {
+	return ((word & 0xF0F0F0F0F0F0F0F0) |
+	        (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+	       0x3333333333333333;
+}
+
+// value of 8 ascii digits (as a little endian word, so the first digit is the lowest
+// byte), each step combines neighbouring lanes: 1 digit -> 2 -> 4 -> 8
+inline uint64_t
+parse_eight_digits(uint64_t word) {
+	word = ((word & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+	word = ((word & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+	return ((word & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+inline bool
+is_digit(const char c) {
+	return '0' <= c && c <= '9';
+}
+
+// parse the digits at the start of [first, last) into value, returns one past the last
+// digit read (first if there are none, in which case value is untouched)
+inline const char *
+parse_uint(const char *first, const char *last, uint64_t &value) {
+	const char *p = first;
+	uint64_t v = 0;
+
+	while (last - p >= 8) {
+		uint64_t word;
+		std::memcpy(&word, p, sizeof(word));
+		if (!is_eight_digits(word)) {
+			break;
+		}
+		v = v * 100000000 + parse_eight_digits(word);
+		p += 8;
+	}
+
+	// the tail is at most 7 digits, so it can't overflow and there's always a power of
+	// ten to shift the SWAR part up by
+	uint64_t tail = 0;
+	auto [end, ec] = std::from_chars(p, last, tail);
+	if (ec != std::errc{}) {
+		if (p != first) {
+			value = v;
+		}
+		return p;
+	}
+
+	value = v * powers_of_ten[end - p] + tail;
+	return end;
+}
+
+inline const char *
+parse_uint(const std::string_view s, uint64_t &value) {
+	return parse_uint(s.data(), s.data() + s.size(), value);
+}
+
+// Walks a line pulling out each unsigned integer in turn, anything that is not a digit
+// is treated as a separator, so "seeds: 79 14" gives 79 then 14
+typedef struct Scanner {
+		const char *p;
+		const char *end;
+
+		explicit Scanner(const std::string_view s) : p(s.data()), end(s.data() + s.size()) {
+		}
+
+		inline bool next(uint64_t &value) {
+			while (p != end && !is_digit(*p)) {
+				p++;
+			}
+			if (p == end) {
+				return false;
+			}
+			p = parse_uint(p, end, value);
+			return true;
+		};
+
+		inline std::string_view rest() const {
+			return {p, (size_t) (end - p)};
+		};
+} scanner_t;
+
+}   // namespace scan
@@ -1,53 +1,18 @@
-#include <fstream>
 #include <iostream>
-#include <optional>
-#include <ranges>
-#include <string>
 
-#define digit(d) static_cast<u_int64_t>(d - '0')
-
-const std::optional<const char>
-first_digit_in_line(const std::string line) {
-	for (auto c : line) {
-		if (isdigit(c)) {
-			return c;
-		}
-	}
-	return std::nullopt;
-}
-
-const std::optional<const char>
-last_digit_in_line(const std::string line) {
-	for (auto c : std::views::reverse(line)) {
-		if (isdigit(c)) {
-			return c;
-		}
-	}
-	return std::nullopt;
-}
-
-u_int64_t
-calc_calibration_value(const std::string line) {
-	return 10 * digit(first_digit_in_line(line).value_or('0')) +
-	       digit(last_digit_in_line(line).value_or('0'));
-}
+#include "../../common/input.hpp"
+#include "../src/calibration.hpp"
 
 int
 main() {
-	std::string line;
-	std::ifstream file("day1/data/1.in");
+	auto file = input::map_file("day1/data/1.in");
 
-	u_int64_t summation = 0;
-
-	if (!file.is_open()) {
+	if (!file.has_value()) {
 		std::cout << "fatal: file not found" << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	while (std::getline(file, line)) {
-		summation += calc_calibration_value(line);
-	}
-	file.close();
+	auto summation = calibration::numeric::sum_calibration_values(file->lines());
 
 	std::cout << "result: " << summation << std::endl;
 
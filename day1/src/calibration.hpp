@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../../common/input.hpp"
+#include "../../common/instrument.hpp"
+#include "digit_scan.hpp"
+
+namespace calibration {
+
+inline constexpr u_int64_t
+digit(const char d) {
+	return static_cast<u_int64_t>(d - '0');
+}
+
+// part one: only numeric digits count
+namespace numeric {
+
+// both ends are found a block of up to 64 bytes at a time, see digit_scan.hpp
+const std::optional<const char>
+first_digit_in_line(const std::string_view line) {
+	const auto digit_mask = digit_scan::kernel();
+
+	for (size_t start = 0; start < line.length(); start += 64) {
+		const size_t n = std::min(line.length() - start, (size_t) 64);
+		if (const uint64_t digits = digit_mask(line.data() + start, n); digits != 0) {
+			return line[start + std::countr_zero(digits)];
+		}
+	}
+	return std::nullopt;
+}
+
+const std::optional<const char>
+last_digit_in_line(const std::string_view line) {
+	const auto digit_mask = digit_scan::kernel();
+
+	for (size_t end = line.length(); end > 0;) {
+		const size_t start = end > 64 ? end - 64 : 0;
+		if (const uint64_t digits = digit_mask(line.data() + start, end - start);
+		    digits != 0) {
+			return line[start + 63 - std::countl_zero(digits)];
+		}
+		end = start;
+	}
+	return std::nullopt;
+}
+
+u_int64_t
+calc_calibration_value(const std::string_view line) {
+	return 10 * digit(first_digit_in_line(line).value_or('0')) +
+	       digit(last_digit_in_line(line).value_or('0'));
+}
+
+u_int64_t
+sum_calibration_values(const input::lines_t &lines) {
+	INSTRUMENT_PHASE("solve (part one)");
+	INSTRUMENT_NO_ALLOCATIONS("calibration (part one)");
+
+	u_int64_t summation = 0;
+
+	for (auto line : lines) {
+		summation += calc_calibration_value(line);
+		INSTRUMENT_COUNT("lines parsed", 1);
+	}
+
+	return summation;
+}
+
+}   // namespace numeric
+
+// part two: digits may also be spelled out, "one", "two", ...
+namespace spelled {
+
+const std::map<const std::string, const char> digits = {
+    {"zero", '0'}, {"one", '1'}, {"two", '2'},   {"three", '3'}, {"four", '4'},
+    {"five", '5'}, {"six", '6'}, {"seven", '7'}, {"eight", '8'}, {"nine", '9'},
+};
+
+bool
+has_digit_name_at_start(const std::string_view str) {
+	for (const auto &[name, _] : digits) {
+		if (str.find(name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const std::optional<const char>
+digit_from_name_at_start(const std::string_view str) {
+	for (const auto &[name, digit] : digits) {
+		if (str.find(name) == 0) {
+			return digit;
+		}
+	}
+	return std::nullopt;
+}
+
+const std::optional<const char>
+first_digit_in_line(const std::string_view line) {
+	for (size_t i = 0; i < line.length(); i++) {
+		if (const char c = line.at(i); isdigit(c)) {
+			return c;
+		}
+
+		auto substr = line.substr(i, std::string::npos);
+		if (has_digit_name_at_start(substr)) {
+			return digit_from_name_at_start(substr).value();
+		}
+	}
+
+	return std::nullopt;
+}
+
+const std::optional<const char>
+last_digit_in_line(const std::string_view line) {
+	for (ssize_t i = line.length() - 1; i >= 0; i--) {
+		if (const char c = line.at(i); isdigit(c)) {
+			return c;
+		}
+
+		auto substr = line.substr(i, std::string::npos);
+		if (has_digit_name_at_start(substr)) {
+			return digit_from_name_at_start(substr).value();
+		}
+	}
+
+	return std::nullopt;
+}
+
+u_int64_t
+calc_calibration_value(const std::string_view line) {
+	return 10 * digit(first_digit_in_line(line).value_or('0')) +
+	       digit(last_digit_in_line(line).value_or('0'));
+}
+
+u_int64_t
+sum_calibration_values(const input::lines_t &lines) {
+	INSTRUMENT_PHASE("solve (part two)");
+	INSTRUMENT_NO_ALLOCATIONS("calibration (part two)");
+
+	u_int64_t summation = 0;
+
+	for (auto line : lines) {
+		summation += calc_calibration_value(line);
+		INSTRUMENT_COUNT("lines parsed", 1);
+	}
+
+	return summation;
+}
+
+}   // namespace spelled
+
+}   // namespace calibration
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "../../common/dispatch.hpp"
+
+namespace digit_scan {
+
+// Marks the digits among up to 64 bytes, bit i standing for byte i, so the first and
+// last digit of a line are a count of trailing and leading zeros rather than a walk
+// from each end. A byte c is a digit when c - '0' (wrapping) is at most 9.
+
+// bytes [0, n) of p, n at most 64
+inline uint64_t
+mask_scalar(const char *p, const size_t n) {
+	uint64_t mask = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		mask |= (uint64_t) ((uint8_t) (p[i] - '0') <= 9) << i;
+	}
+
+	return mask;
+}
+
+// four 16 byte quarters
+TARGET_SSE42 inline uint64_t
+mask_sse42(const char *p, const size_t n) {
+	alignas(16) char block[64];
+	p = dispatch::padded(p, n, block);   // zero bytes aren't digits
+
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+
+	uint64_t mask = 0;
+	for (size_t i = 0; i < 4; i++) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *) (p + 16 * i));
+		const __m128i offset = _mm_sub_epi8(bytes, zero);
+		const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(offset, nine), offset);
+		mask |= (uint64_t) (uint16_t) _mm_movemask_epi8(is_digit) << (16 * i);
+	}
+
+	return mask;
+}
+
+// two 32 byte halves
+TARGET_AVX2 inline uint64_t
+mask_avx2(const char *p, const size_t n) {
+	alignas(32) char block[64];
+	p = dispatch::padded(p, n, block);
+
+	const __m256i zero = _mm256_set1_epi8('0');
+	const __m256i nine = _mm256_set1_epi8(9);
+
+	uint64_t mask = 0;
+	for (size_t i = 0; i < 2; i++) {
+		const __m256i bytes = _mm256_loadu_si256((const __m256i *) (p + 32 * i));
+		const __m256i offset = _mm256_sub_epi8(bytes, zero);
+		const __m256i is_digit =
+		    _mm256_cmpeq_epi8(_mm256_min_epu8(offset, nine), offset);
+		mask |= (uint64_t) (uint32_t) _mm256_movemask_epi8(is_digit) << (32 * i);
+	}
+
+	return mask;
+}
+
+// all 64 at once, the masked load reads only the n bytes asked for
+TARGET_AVX512 inline uint64_t
+mask_avx512(const char *p, const size_t n) {
+	const __mmask64 in_range = n == 64 ? ~(__mmask64) 0 : ((__mmask64) 1 << n) - 1;
+	const __m512i bytes = _mm512_maskz_loadu_epi8(in_range, p);
+	const __m512i offset = _mm512_sub_epi8(bytes, _mm512_set1_epi8('0'));
+
+	return _mm512_mask_cmple_epu8_mask(in_range, offset, _mm512_set1_epi8(9));
+}
+
+typedef uint64_t (*kernel_t)(const char *p, const size_t n);
+
+// the best variant for this machine, look it up once outside a loop
+inline kernel_t
+kernel() {
+	static const kernel_t chosen =
+	    dispatch::select<kernel_t>(mask_scalar, mask_sse42, mask_avx2, mask_avx512);
+	return chosen;
+}
+
+}   // namespace digit_scan
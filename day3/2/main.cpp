@@ -1,223 +1,145 @@
-#include <algorithm>
-#include <fstream>
+#include <filesystem>
+#include <functional>
 #include <iostream>
-#include <memory>
 #include <numeric>
-#include <optional>
 #include <string>
-#include <vector>
-
-typedef struct Position {
-		const u_int8_t col;
-		const u_int8_t row;
-} position_t;
-
-typedef struct Symbol {
-		const char c;
-		const position_t pos;
-} symbol_t;
-
-typedef struct Number {
-		const uint16_t v;
-		const position_t start;
-		const position_t end;
-} number_t;
-
-typedef struct Schematic {
-		std::vector<symbol_t> symbols;
-		std::vector<number_t> numbers;
-} schematic_t;
-
-inline constexpr bool
-is_noop(const char c) {
-	return c == '.';
-}
-
-inline constexpr bool
-is_symbol(const char c) {
-	return c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '$' ||
-	       c == '=' || c == '&' || c == '@' || c == '#';
-}
 
-inline constexpr bool
-is_digit(const char c) {
-	// I could use isdigit(...) but this is consistent with the others
-	return '0' <= c && c <= '9';
-}
+#include "../../common/arena.hpp"
+#include "../../common/input.hpp"
+#include "../src/adjacency.hpp"
+#include "../src/bitboard.hpp"
+#include "../src/incremental.hpp"
+#include "../src/label_grid.hpp"
+#include "../src/schematic.hpp"
+#include "../src/schematic_cache.hpp"
+#include "../src/streaming.hpp"
+#include "../src/tiled.hpp"
 
-std::unique_ptr<const schematic_t>
-parse(const std::vector<std::string> &data) {
-	auto schematic = std::make_unique<schematic_t>();
-
-	for (u_int8_t row = 0; row < data.size();) {
-		auto line = data.at(row);
-
-		for (uint8_t col = 0; col < line.length();) {
-			char c = line.at(col);
-
-			if (is_noop(c)) {
-				col++;
-			} else if (is_symbol(c)) {
-				schematic->symbols.push_back({c, {col, row}});
-				col++;
-			} else if (is_digit(c)) {
-				uint8_t length = 1;
-				while (length <= 3 && col + length < line.length() &&
-				       is_digit(line.at(col + length))) {
-					length++;
-				}
-
-				char buf[4]{'\0'};
-				line.copy(buf, length, col);
-
-				const uint16_t v = (uint16_t) atoi(buf);
-				const uint8_t col_ = col + length - 1;
-				schematic->numbers.push_back({v, {col, row}, {col_, row}});
-
-				col += length;
-			} else {
-				std::cout << "unrecognised symbol: " << c << std::endl;
-				col++;
-			}
+int
+main(int argc, char *argv[]) {
+	const std::string engine{argc > 1 ? argv[1] : "naive"};
+	const std::filesystem::path filepath{argc > 2 ? argv[2] : "day3/data/3.in"};
+
+	if (engine == "stream") {
+		// with --rows each row's sums are printed as soon as the row below it has been
+		// read, rather than only the totals at the end
+		std::function<void(const streaming::row_results_t &)> on_row;
+		if (argc > 3 && std::string(argv[3]) == "--rows") {
+			on_row = [](const streaming::row_results_t &row) {
+				std::cout << "row " << row.row << ": " << row.part_sum << ", "
+				          << row.gear_ratio_sum << std::endl;
+			};
 		}
 
-		row++;
-	}
-
-	return schematic;
-}
-
-std::optional<std::unique_ptr<std::vector<std::string>>>
-read_file(const std::string filename) {
-	std::ifstream file(filename);
-
-	if (!file.is_open()) {
-		return std::nullopt;
-	}
-
-	std::string line;
-	auto lines = std::make_unique<std::vector<std::string>>();
-
-	while (getline(file, line)) {
-		lines->push_back(line);
-	}
-
-	return lines;
-}
-
-inline bool
-is_adjacent(const symbol_t s, const number_t n) {
-	// cast to signed to avoid overflow/underflow
-	int16_t x0 = (int16_t) n.start.col - 1;
-	int16_t y0 = (int16_t) n.start.row - 1;
-	int16_t x1 = (int16_t) n.end.col + 1;
-	int16_t y1 = (int16_t) n.end.row + 1;
+		// never holds more than three rows so there are no totals to report
+		auto results = streaming::solve_file(filepath, on_row);
 
-	return ((x0 <= s.pos.col && s.pos.col <= x1) &&
-	        (y0 <= s.pos.row && s.pos.row <= y1));
-}
-
-inline bool
-is_engine_part(const schematic_t &schematic, const number_t n) {
-	return std::any_of(schematic.symbols.begin(), schematic.symbols.end(),
-	                   [n](const auto &s) { return is_adjacent(s, n); });
-}
-
-std::unique_ptr<std::vector<number_t>>
-find_engine_parts(const schematic_t &schematic) {
-	auto parts = std::make_unique<std::vector<number_t>>();
-
-	for (auto n : schematic.numbers) {
-		if (is_engine_part(schematic, n)) {
-			parts->push_back(n);
+		if (!results.has_value()) {
+			std::cout << "fatal: file not found" << std::endl;
+			return EXIT_FAILURE;
 		}
-	}
 
-	return parts;
-}
-
-inline bool
-is_gear(const schematic_t &schematic, const symbol_t s) {
-	size_t n_adjacent_numbers =
-	    std::count_if(schematic.numbers.begin(), schematic.numbers.end(),
-	                  [s](const auto &n) { return is_adjacent(s, n); });
-	return n_adjacent_numbers == 2;
-}
+		std::cout << "  of which engine parts : " << results->n_engine_parts << std::endl;
+		std::cout << std::endl;
+		std::cout << "result (part one): " << results->part_sum << std::endl;
+		std::cout << "result (part two): " << results->gear_ratio_sum << std::endl;
 
-uint64_t
-calc_gear_ratio(const std::vector<number_t> &numbers) {
-	uint64_t product{1};
-
-	for (auto n : numbers) {
-		product *= (uint64_t) n.v;
+		return EXIT_SUCCESS;
 	}
 
-	return product;
-}
-
-std::unique_ptr<std::vector<number_t>>
-find_adjacent_numbers(const schematic_t &schematic, const symbol_t s) {
-	auto numbers = std::make_unique<std::vector<number_t>>();
+	auto file = input::map_file(filepath);
 
-	for (auto n : schematic.numbers) {
-		if (is_adjacent(s, n)) {
-			numbers->push_back(n);
-		}
+	if (!file.has_value()) {
+		std::cout << "fatal: file not found" << std::endl;
+		return EXIT_FAILURE;
 	}
 
-	return numbers;
-}
+	arena::arena_t arena(file->contents().size());
 
-std::unique_ptr<std::vector<uint64_t>>
-find_gear_ratios(const schematic_t &schematic) {
-	auto gears_ratios = std::make_unique<std::vector<uint64_t>>();
+	// bitboard, tiled and incremental work on the lines themselves, the others only on
+	// the schematic, which a cache hit loads without them. bitboard and tiled warn about
+	// the characters they skip themselves.
+	const bool uses_lines = engine == "bitboard" || engine == "tiled" ||
+	                        engine == "incremental";
+	const bool uses_schematic = engine == "naive" || engine == "label-grid" ||
+	                            engine == "graph" || engine == "incremental";
 
-	for (auto s : schematic.symbols) {
-		if (!is_gear(schematic, s))
-			continue;
-		gears_ratios->push_back(calc_gear_ratio(*find_adjacent_numbers(schematic, s)));
+	std::vector<std::string_view> data;
+	if (uses_lines) {
+		data = input::collect(file->lines());
 	}
 
-	return gears_ratios;
-}
-
-uint64_t
-sum_engine_part_values(const std::vector<number_t> &parts) {
-	uint64_t sum{0};
-
-	for (auto p : parts) {
-		sum += (uint64_t) p.v;
+	std::unique_ptr<const schematic::schematic_t> schematic;
+	if (uses_schematic && uses_lines) {
+		schematic = schematic_cache::parse(file->contents(), data, arena.resource());
+	} else if (uses_schematic) {
+		schematic = schematic_cache::parse(file->contents(), arena.resource());
 	}
 
-	return sum;
-}
+	schematic::results_t results;
+
+	if (engine == "naive") {
+		// part one
+		auto engine_parts = schematic::find_engine_parts(*schematic);
+
+		// part two
+		auto gear_ratios = schematic::find_gear_ratios(*schematic);
+
+		results = {engine_parts->size(),
+		           schematic::sum_engine_part_values(*engine_parts),
+		           std::accumulate(gear_ratios->begin(), gear_ratios->end(), 0ul)};
+	} else if (engine == "label-grid") {
+		results = label_grid::solve(*schematic);
+	} else if (engine == "graph") {
+		const auto graph = adjacency::build(*schematic);
+		results = adjacency::solve(*schematic, graph);
+
+		// other questions are the same kind of walk over the graph
+		std::cout << "symbols next to 1 number: "
+		          << adjacency::symbols_with_degree(graph, 1).size() << std::endl;
+		std::cout << "parts next to '#'       : "
+		          << adjacency::sum_of_parts_next_to(*schematic, graph, '#')
+		          << std::endl;
+		std::cout << std::endl;
+	} else if (engine == "bitboard") {
+		results = bitboard::solve(data);
+	} else if (engine == "tiled") {
+		results = tiled::solve(data);
+	} else if (engine == "incremental") {
+		auto editable = incremental::build(data);
+
+		// any further arguments are edits, "ROW,COL,C", applied in turn with the sums
+		// updated after each rather than solved again
+		for (int i = 3; i < argc; i++) {
+			const auto edit = incremental::parse_edit(argv[i]);
+			if (!edit.has_value() ||
+			    !editable.apply_edit(edit->row, edit->col, edit->c)) {
+				std::cout << "fatal: bad edit (want ROW,COL,C inside the schematic): "
+				          << argv[i] << std::endl;
+				return EXIT_FAILURE;
+			}
 
-int
-main() {
-	auto possible_data = read_file("day3/data/3.in");
+			std::cout << "after " << argv[i] << ": " << editable.results.part_sum
+			          << ", " << editable.results.gear_ratio_sum << std::endl;
+		}
+		if (argc > 3) {
+			std::cout << std::endl;
+		}
 
-	if (!possible_data.has_value()) {
-		std::cout << "fatal: file not found" << std::endl;
+		results = editable.results;
+	} else {
+		std::cout << "fatal: unknown engine: " << engine << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	auto data = std::move(possible_data.value());
-	auto schematic = parse(*data);
-
-	// part one
-	auto engine_parts = find_engine_parts(*schematic);
-	auto part_1_result = sum_engine_part_values(*engine_parts);
-
-	std::cout << "total number of symbols : " << schematic->symbols.size() << std::endl;
-	std::cout << "total number of parts   : " << schematic->numbers.size() << std::endl;
-	std::cout << "  of which engine parts : " << engine_parts->size() << std::endl;
+	if (schematic != nullptr) {
+		std::cout << "total number of symbols : " << schematic->n_symbols() << std::endl;
+		std::cout << "total number of parts   : " << schematic->n_numbers() << std::endl;
+	}
+	std::cout << "  of which engine parts : " << results.n_engine_parts << std::endl;
 	std::cout << std::endl;
-	std::cout << "result (part one): " << part_1_result << std::endl;
-
-	// part two
-	auto gear_ratios = find_gear_ratios(*schematic);
-	auto part_2_result = std::accumulate(gear_ratios->begin(), gear_ratios->end(), 0);
-	std::cout << "result (part two): " << part_2_result << std::endl;
+	std::cout << "result (part one): " << results.part_sum << std::endl;
+	std::cout << "result (part two): " << results.gear_ratio_sum << std::endl;
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "label_grid.hpp"
+#include "schematic.hpp"
+
+namespace adjacency {
+
+// Which numbers touch which symbols, worked out once (through a label grid, so in
+// time linear in the cells) and kept as a graph in compressed sparse row form: symbol
+// i's numbers are symbol_neighbours from symbol_offsets[i] up to symbol_offsets[i + 1],
+// and the same the other way round for numbers. Part one, part two and any other
+// question about adjacency are then a walk over these arrays instead of another scan
+// of the schematic.
+//
+// Indices are those of the schematic's arrays, neighbours are listed in index order.
+
+typedef struct Graph {
+		std::vector<uint32_t> symbol_offsets;      // n_symbols + 1
+		std::vector<uint32_t> symbol_neighbours;   // number indices
+		std::vector<uint32_t> number_offsets;      // n_numbers + 1
+		std::vector<uint32_t> number_neighbours;   // symbol indices
+
+		inline size_t n_edges() const {
+			return symbol_neighbours.size();
+		};
+
+		inline std::span<const uint32_t> numbers_of(const size_t symbol) const {
+			return {symbol_neighbours.data() + symbol_offsets[symbol],
+			        symbol_neighbours.data() + symbol_offsets[symbol + 1]};
+		};
+
+		inline std::span<const uint32_t> symbols_of(const size_t number) const {
+			return {number_neighbours.data() + number_offsets[number],
+			        number_neighbours.data() + number_offsets[number + 1]};
+		};
+
+		inline size_t symbol_degree(const size_t symbol) const {
+			return symbol_offsets[symbol + 1] - symbol_offsets[symbol];
+		};
+
+		inline size_t number_degree(const size_t number) const {
+			return number_offsets[number + 1] - number_offsets[number];
+		};
+} graph_t;
+
+graph_t
+build(const schematic::schematic_t &schematic) {
+	INSTRUMENT_PHASE("build (adjacency)");
+
+	const auto grid = label_grid::build(schematic);
+	const ssize_t w = (ssize_t) grid.width;
+	const std::array<ssize_t, 8> offsets{-w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1};
+
+	graph_t graph;
+	graph.symbol_offsets.reserve(schematic.n_symbols() + 1);
+	graph.symbol_offsets.push_back(0);
+
+	// symbol -> numbers straight from the grid, each symbol's row sorted so both
+	// directions come out in index order
+	for (size_t i = 0; i < schematic.n_symbols(); i++) {
+		const size_t cell =
+		    grid.index(schematic.symbol_cols[i], schematic.symbol_rows[i]);
+		const size_t first = graph.symbol_neighbours.size();
+
+		for (auto offset : offsets) {
+			const auto label = grid.labels[cell + offset];
+			if (label == label_grid::NO_LABEL) {
+				continue;
+			}
+
+			// a number spanning several neighbouring cells is only listed once
+			const auto begin = graph.symbol_neighbours.begin() + first;
+			if (std::find(begin, graph.symbol_neighbours.end(), label - 1) ==
+			    graph.symbol_neighbours.end()) {
+				graph.symbol_neighbours.push_back(label - 1);
+			}
+		}
+
+		std::sort(graph.symbol_neighbours.begin() + first,
+		          graph.symbol_neighbours.end());
+		graph.symbol_offsets.push_back((uint32_t) graph.symbol_neighbours.size());
+	}
+
+	// number -> symbols by transposing: count degrees, prefix sum, then fill. Symbols
+	// are visited in index order so each number's symbols end up sorted.
+	graph.number_offsets.assign(schematic.n_numbers() + 1, 0);
+	for (auto n : graph.symbol_neighbours) {
+		graph.number_offsets[n + 1]++;
+	}
+	for (size_t i = 0; i < schematic.n_numbers(); i++) {
+		graph.number_offsets[i + 1] += graph.number_offsets[i];
+	}
+
+	graph.number_neighbours.resize(graph.symbol_neighbours.size());
+	std::vector<uint32_t> next(graph.number_offsets.begin(),
+	                           graph.number_offsets.end() - 1);
+	for (size_t s = 0; s < schematic.n_symbols(); s++) {
+		for (auto n : graph.numbers_of(s)) {
+			graph.number_neighbours[next[n]++] = (uint32_t) s;
+		}
+	}
+
+	INSTRUMENT_COUNT("adjacency edges", graph.n_edges());
+
+	return graph;
+}
+
+// part one and two: numbers next to any symbol, and symbols next to exactly two numbers
+schematic::results_t
+solve(const schematic::schematic_t &schematic, const graph_t &graph) {
+	INSTRUMENT_PHASE("solve (adjacency)");
+	INSTRUMENT_NO_ALLOCATIONS("adjacency walk");
+
+	schematic::results_t results{0, 0, 0};
+
+	for (size_t i = 0; i < schematic.n_numbers(); i++) {
+		if (graph.number_degree(i) > 0) {
+			results.n_engine_parts++;
+			results.part_sum += schematic.number_values[i];
+		}
+	}
+
+	for (size_t i = 0; i < schematic.n_symbols(); i++) {
+		const auto numbers = graph.numbers_of(i);
+		if (numbers.size() == 2) {
+			results.gear_ratio_sum += schematic.number_values[numbers[0]] *
+			                          schematic.number_values[numbers[1]];
+		}
+	}
+
+	return results;
+}
+
+schematic::results_t
+solve(const schematic::schematic_t &schematic) {
+	return solve(schematic, build(schematic));
+}
+
+// indices of the symbols next to exactly k numbers
+std::vector<uint32_t>
+symbols_with_degree(const graph_t &graph, const size_t k) {
+	std::vector<uint32_t> symbols;
+
+	for (size_t i = 0; i + 1 < graph.symbol_offsets.size(); i++) {
+		if (graph.symbol_degree(i) == k) {
+			symbols.push_back((uint32_t) i);
+		}
+	}
+
+	return symbols;
+}
+
+// sum of the numbers next to at least one symbol c, each counted once
+uint64_t
+sum_of_parts_next_to(const schematic::schematic_t &schematic, const graph_t &graph,
+                     const char c) {
+	uint64_t sum{0};
+
+	for (size_t i = 0; i < schematic.n_numbers(); i++) {
+		const auto symbols = graph.symbols_of(i);
+		if (std::ranges::any_of(
+		        symbols, [&](uint32_t s) { return schematic.symbol_chars[s] == c; })) {
+			sum += schematic.number_values[i];
+		}
+	}
+
+	return sum;
+}
+
+}   // namespace adjacency
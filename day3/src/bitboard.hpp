@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "../../common/pages.hpp"
+#include "classify.hpp"
+#include "schematic.hpp"
+
+namespace bitboard {
+
+// Each row of the schematic becomes a bitmask of digits and a bitmask of symbols, bit
+// i of word k being column 64k + i. Dilating the symbol mask by one cell in every
+// direction (shifts and ORs within a row, then OR with the rows above and below) and
+// ANDing it with the digit mask marks every digit touching a symbol, 64 columns at a
+// time. Growing those marks along their digit runs then gives the engine parts.
+//
+// The masks come from pages::resource(), so are on huge pages with AOC_HUGE_PAGES.
+
+typedef struct Bitboard {
+		size_t width;
+		size_t height;
+		size_t n_words;   // words per row
+		std::pmr::vector<uint64_t> digits;
+		std::pmr::vector<uint64_t> symbols;
+		size_t n_unrecognised = 0;   // characters neither digit, symbol nor '.'
+
+		inline bool test(const std::pmr::vector<uint64_t> &mask, const ssize_t col,
+		                 const ssize_t row) const {
+			if (col < 0 || row < 0 || (size_t) col >= width || (size_t) row >= height) {
+				return false;
+			}
+			return (mask[row * n_words + col / 64] >> (col % 64)) & 1;
+		};
+} bitboard_t;
+
+bitboard_t
+build(const std::vector<std::string_view> &data) {
+	size_t width = 0;
+	for (const auto &line : data) {
+		width = std::max(width, line.length());
+	}
+
+	const size_t n_words = (width + 63) / 64;
+	bitboard_t board{width, data.size(), n_words,
+	                 std::pmr::vector<uint64_t>(pages::resource()),
+	                 std::pmr::vector<uint64_t>(pages::resource())};
+	board.digits.assign(board.height * n_words, 0);
+	board.symbols.assign(board.height * n_words, 0);
+
+	// a word is a block of the classifier's masks as they are
+	const auto classify = classify::kernel();
+	for (size_t row = 0; row < data.size(); row++) {
+		const auto &line = data.at(row);
+
+		for (size_t k = 0; k * 64 < line.length(); k++) {
+			const size_t n = std::min(line.length() - k * 64, (size_t) 64);
+			const auto masks = classify(line.data() + k * 64, n);
+
+			board.digits[row * n_words + k] = masks.digits;
+			board.symbols[row * n_words + k] = masks.symbols;
+
+			const uint64_t all = n == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+			board.n_unrecognised += (size_t) std::popcount(
+			    all & ~(masks.digits | masks.symbols | masks.dots));
+		}
+	}
+
+	return board;
+}
+
+// move every bit of a row one column to the right (col + 1), carrying between words
+inline uint64_t
+shift_right(const uint64_t *row, const size_t k) {
+	return (row[k] << 1) | (k > 0 ? row[k - 1] >> 63 : 0);
+}
+
+// move every bit of a row one column to the left (col - 1), carrying between words
+inline uint64_t
+shift_left(const uint64_t *row, const size_t k, const size_t n_words) {
+	return (row[k] >> 1) | (k + 1 < n_words ? row[k + 1] << 63 : 0);
+}
+
+std::pmr::vector<uint64_t>
+find_engine_part_mask(const bitboard_t &board) {
+	const size_t n_words = board.n_words;
+
+	// horizontal dilation of each symbol row
+	std::pmr::vector<uint64_t> dilated(board.symbols.size(), 0, pages::resource());
+	for (size_t row = 0; row < board.height; row++) {
+		const uint64_t *symbols = &board.symbols[row * n_words];
+		for (size_t k = 0; k < n_words; k++) {
+			dilated[row * n_words + k] = symbols[k] | shift_right(symbols, k) |
+			                             shift_left(symbols, k, n_words);
+		}
+	}
+
+	// vertical dilation, masked down to the digits touching a symbol
+	std::pmr::vector<uint64_t> parts(board.digits.size(), 0, pages::resource());
+	for (size_t row = 0; row < board.height; row++) {
+		for (size_t k = 0; k < n_words; k++) {
+			const size_t i = row * n_words + k;
+			uint64_t d = dilated[i];
+			if (row > 0) {
+				d |= dilated[i - n_words];
+			}
+			if (row + 1 < board.height) {
+				d |= dilated[i + n_words];
+			}
+			parts[i] = d & board.digits[i];
+		}
+	}
+
+	// grow the marked digits to cover their whole run, each pass extends a mark by one
+	// column either way so this takes as many passes as the longest number is long
+	for (size_t row = 0; row < board.height; row++) {
+		uint64_t *part = &parts[row * n_words];
+		const uint64_t *digits = &board.digits[row * n_words];
+
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (size_t k = 0; k < n_words; k++) {
+				const uint64_t grown =
+				    (part[k] | shift_right(part, k) | shift_left(part, k, n_words)) &
+				    digits[k];
+				changed |= grown != part[k];
+				part[k] = grown;
+			}
+		}
+	}
+
+	return parts;
+}
+
+schematic::results_t
+solve(const std::vector<std::string_view> &data) {
+	INSTRUMENT_PHASE("solve (bitboard)");
+
+	const auto board = build(data);
+	schematic::warn_unrecognised(board.n_unrecognised);
+
+	const auto parts = find_engine_part_mask(board);
+	const size_t n_words = board.n_words;
+
+	schematic::results_t results{0, 0, 0};
+
+	// part one: one number per run start, i.e. a part bit with no part bit to its left
+	for (size_t row = 0; row < board.height; row++) {
+		const uint64_t *part = &parts[row * n_words];
+
+		for (size_t k = 0; k < n_words; k++) {
+			uint64_t starts = part[k] & ~shift_right(part, k);
+			while (starts != 0) {
+				const size_t col = k * 64 + std::countr_zero(starts);
+				starts &= starts - 1;
+
+				results.n_engine_parts++;
+				results.part_sum += schematic::number_at(data.at(row), col);
+			}
+		}
+	}
+
+	// part two: a gear has exactly two digit runs in its 3x3 window, a run starts at
+	// the left edge of the window or at a digit with no digit to its left
+	for (size_t row = 0; row < board.height; row++) {
+		for (size_t k = 0; k < n_words; k++) {
+			uint64_t symbols = board.symbols[row * n_words + k];
+
+			while (symbols != 0) {
+				const ssize_t col = k * 64 + std::countr_zero(symbols);
+				symbols &= symbols - 1;
+
+				size_t n_adjacent = 0;
+				uint64_t ratio = 1;
+
+				for (ssize_t r = (ssize_t) row - 1; r <= (ssize_t) row + 1; r++) {
+					for (ssize_t c = col - 1; c <= col + 1; c++) {
+						if (!board.test(board.digits, c, r)) {
+							continue;
+						}
+						if (c != col - 1 && board.test(board.digits, c - 1, r)) {
+							continue;
+						}
+
+						n_adjacent++;
+						ratio *= schematic::number_at(data.at(r), c);
+					}
+				}
+
+				if (n_adjacent == 2) {
+					results.gear_ratio_sum += ratio;
+				}
+			}
+		}
+	}
+
+	return results;
+}
+
+}   // namespace bitboard
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "../../common/dispatch.hpp"
+
+namespace classify {
+
+// Sorts up to 64 bytes of a schematic row at once into digit, symbol and dot masks, bit
+// i standing for byte i, so the parser only visits the bytes where something starts.
+//
+// Each byte's class is looked up by nibble: lo[c & 0xF] & hi[c >> 4], the bits set in
+// both tables being the classes c could be. Vector shuffles do 16, 32 or 64 lookups in
+// one instruction (SSE4.2, AVX2, AVX-512, picked at run time by common/dispatch.hpp),
+// the scalar path uses the same tables one byte at a time.
+//
+// Anything in none of the masks is unrecognised.
+
+constexpr uint8_t DIGIT = 0x01;
+constexpr uint8_t DOT = 0x02;
+constexpr uint8_t SYMBOL_2X = 0x04;   // # $ % & * + - /
+constexpr uint8_t SYMBOL_3X = 0x08;   // =
+constexpr uint8_t SYMBOL_4X = 0x10;   // @
+constexpr uint8_t SYMBOL = SYMBOL_2X | SYMBOL_3X | SYMBOL_4X;
+
+// by low nibble
+constexpr std::array<uint8_t, 16> lo{
+    DIGIT | SYMBOL_4X,   // 0 @
+    DIGIT,
+    DIGIT,
+    DIGIT | SYMBOL_2X,   // 3 #
+    DIGIT | SYMBOL_2X,   // 4 $
+    DIGIT | SYMBOL_2X,   // 5 %
+    DIGIT | SYMBOL_2X,   // 6 &
+    DIGIT,
+    DIGIT,
+    DIGIT,
+    SYMBOL_2X,               // a *
+    SYMBOL_2X,               // b +
+    0,                       //
+    SYMBOL_2X | SYMBOL_3X,   // d - =
+    DOT,                     // e .
+    SYMBOL_2X,               // f /
+};
+
+// by high nibble, nothing at or above 0x80
+constexpr std::array<uint8_t, 16> hi{
+    0, 0, DOT | SYMBOL_2X, DIGIT | SYMBOL_3X, SYMBOL_4X, 0, 0, 0,
+    0, 0, 0,               0,                 0,         0, 0, 0,
+};
+
+// shuffles look up within each 16 byte lane, so wider vectors need a copy per lane
+template <size_t N>
+constexpr std::array<uint8_t, N>
+repeated(const std::array<uint8_t, 16> &table) {
+	std::array<uint8_t, N> out{};
+	for (size_t i = 0; i < N; i++) {
+		out[i] = table[i % 16];
+	}
+	return out;
+}
+
+constexpr auto lo_x4 = repeated<64>(lo);
+constexpr auto hi_x4 = repeated<64>(hi);
+
+typedef struct Masks {
+		uint64_t digits;
+		uint64_t symbols;
+		uint64_t dots;
+} masks_t;
+
+inline uint8_t
+class_of(const char c) {
+	return lo[(uint8_t) c & 0xF] & hi[(uint8_t) c >> 4];
+}
+
+// bytes [0, n) of p, n at most 64
+inline masks_t
+classify_scalar(const char *p, const size_t n) {
+	masks_t masks{0, 0, 0};
+
+	for (size_t i = 0; i < n; i++) {
+		const uint8_t c = class_of(p[i]);
+		const uint64_t bit = (uint64_t) 1 << i;
+
+		masks.digits |= (c & DIGIT) ? bit : 0;
+		masks.symbols |= (c & SYMBOL) ? bit : 0;
+		masks.dots |= (c & DOT) ? bit : 0;
+	}
+
+	return masks;
+}
+
+// bit i set where byte i of classes has any of bits
+TARGET_SSE42 inline uint64_t
+any_of_sse42(const __m128i classes, const uint8_t bits) {
+	const __m128i selected = _mm_and_si128(classes, _mm_set1_epi8((char) bits));
+	const __m128i none = _mm_cmpeq_epi8(selected, _mm_setzero_si128());
+	return (uint16_t) ~_mm_movemask_epi8(none);
+}
+
+TARGET_SSE42 inline masks_t
+classify_sse42_16(const char *p) {
+	const __m128i lo_lut = _mm_loadu_si128((const __m128i *) lo.data());
+	const __m128i hi_lut = _mm_loadu_si128((const __m128i *) hi.data());
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+
+	// there is no 8 bit shift, the bits a 16 bit one drags in are masked off
+	const __m128i bytes = _mm_loadu_si128((const __m128i *) p);
+	const __m128i lo_nibbles = _mm_and_si128(bytes, nibble);
+	const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble);
+	const __m128i classes = _mm_and_si128(_mm_shuffle_epi8(lo_lut, lo_nibbles),
+	                                      _mm_shuffle_epi8(hi_lut, hi_nibbles));
+
+	return {any_of_sse42(classes, DIGIT), any_of_sse42(classes, SYMBOL),
+	        any_of_sse42(classes, DOT)};
+}
+
+// four 16 byte quarters
+TARGET_SSE42 inline masks_t
+classify_sse42(const char *p, const size_t n) {
+	alignas(16) char block[64];
+	p = dispatch::padded(p, n, block);   // zero bytes are in no class
+
+	masks_t masks{0, 0, 0};
+	for (size_t i = 0; i < 4; i++) {
+		const masks_t quarter = classify_sse42_16(p + 16 * i);
+		masks.digits |= quarter.digits << (16 * i);
+		masks.symbols |= quarter.symbols << (16 * i);
+		masks.dots |= quarter.dots << (16 * i);
+	}
+
+	return masks;
+}
+
+// bit i set where byte i of classes has any of bits
+TARGET_AVX2 inline uint64_t
+any_of_avx2(const __m256i classes, const uint8_t bits) {
+	const __m256i selected = _mm256_and_si256(classes, _mm256_set1_epi8((char) bits));
+	const __m256i none = _mm256_cmpeq_epi8(selected, _mm256_setzero_si256());
+	return (uint32_t) ~_mm256_movemask_epi8(none);
+}
+
+TARGET_AVX2 inline masks_t
+classify_avx2_32(const char *p) {
+	const __m256i lo_lut = _mm256_loadu_si256((const __m256i *) lo_x4.data());
+	const __m256i hi_lut = _mm256_loadu_si256((const __m256i *) hi_x4.data());
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+	const __m256i bytes = _mm256_loadu_si256((const __m256i *) p);
+	const __m256i lo_nibbles = _mm256_and_si256(bytes, nibble);
+	const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble);
+	const __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(lo_lut, lo_nibbles),
+	                                         _mm256_shuffle_epi8(hi_lut, hi_nibbles));
+
+	return {any_of_avx2(classes, DIGIT), any_of_avx2(classes, SYMBOL),
+	        any_of_avx2(classes, DOT)};
+}
+
+// two 32 byte halves
+TARGET_AVX2 inline masks_t
+classify_avx2(const char *p, const size_t n) {
+	alignas(32) char block[64];
+	p = dispatch::padded(p, n, block);
+
+	const masks_t low = classify_avx2_32(p);
+	const masks_t high = classify_avx2_32(p + 32);
+
+	return {low.digits | (high.digits << 32), low.symbols | (high.symbols << 32),
+	        low.dots | (high.dots << 32)};
+}
+
+// all 64 at once, a masked load reads only the n bytes asked for so a short tail needs
+// no copying
+TARGET_AVX512 inline masks_t
+classify_avx512(const char *p, const size_t n) {
+	const __m512i lo_lut = _mm512_loadu_si512(lo_x4.data());
+	const __m512i hi_lut = _mm512_loadu_si512(hi_x4.data());
+	const __m512i nibble = _mm512_set1_epi8(0x0F);
+
+	const __mmask64 in_range = n == 64 ? ~(__mmask64) 0 : ((__mmask64) 1 << n) - 1;
+	const __m512i bytes = _mm512_maskz_loadu_epi8(in_range, p);
+	const __m512i lo_nibbles = _mm512_and_si512(bytes, nibble);
+	const __m512i hi_nibbles = _mm512_and_si512(_mm512_srli_epi16(bytes, 4), nibble);
+	const __m512i classes = _mm512_and_si512(_mm512_shuffle_epi8(lo_lut, lo_nibbles),
+	                                         _mm512_shuffle_epi8(hi_lut, hi_nibbles));
+
+	return {_mm512_test_epi8_mask(classes, _mm512_set1_epi8(DIGIT)),
+	        _mm512_test_epi8_mask(classes, _mm512_set1_epi8(SYMBOL)),
+	        _mm512_test_epi8_mask(classes, _mm512_set1_epi8(DOT))};
+}
+
+typedef masks_t (*kernel_t)(const char *p, const size_t n);
+
+// the best variant for this machine, look it up once outside a loop
+inline kernel_t
+kernel() {
+	static const kernel_t chosen =
+	    dispatch::select<kernel_t>(classify_scalar, classify_sse42, classify_avx2,
+	                               classify_avx512);
+	return chosen;
+}
+
+// bytes [0, n) of p, n at most 64
+inline masks_t
+classify(const char *p, const size_t n) {
+	return kernel()(p, n);
+}
+
+}   // namespace classify
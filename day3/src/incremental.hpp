@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "../../common/pages.hpp"
+#include "../../common/scan.hpp"
+#include "label_grid.hpp"
+#include "schematic.hpp"
+
+namespace incremental {
+
+// A schematic which can be edited one cell at a time while keeping a running part sum
+// and gear ratio sum.
+//
+// An edit at (row, col) can only change the numbers on that row which touch cols
+// col - 1 to col + 1 (they may grow, shrink, split or merge) and so only the numbers
+// and symbols within one cell of the span [lo, hi] those numbers cover can change their
+// contribution. Everything in that region is subtracted before the edit and added back
+// after it, which is O(length of the numbers touched) rather than O(cells).
+
+typedef struct Entry {
+		uint64_t v;
+		uint32_t row;
+		uint32_t start;
+		uint32_t end;
+} entry_t;
+
+// one cell set to c, rows and cols counted from 0
+typedef struct Edit {
+		size_t row;
+		size_t col;
+		char c;
+} edit_t;
+
+typedef struct MutableSchematic {
+		size_t width;    // including border
+		size_t height;   // including border
+		std::pmr::vector<char> cells;        // both grids from pages::resource()
+		std::pmr::vector<uint32_t> labels;   // see label_grid::NO_LABEL
+		std::vector<entry_t> numbers;   // labels index into this (minus one)
+		std::vector<uint32_t> free_labels;
+		schematic::results_t results;
+
+		inline size_t index(const size_t col, const size_t row) const {
+			return (row + 1) * width + (col + 1);
+		};
+
+		inline size_t n_cols() const {
+			return width - 2;
+		};
+
+		inline size_t n_rows() const {
+			return height - 2;
+		};
+
+		inline char at(const size_t row, const size_t col) const {
+			return cells[index(col, row)];
+		};
+
+		// returns false if (row, col) is outside the schematic
+		bool apply_edit(const size_t row, const size_t col, const char c);
+
+		// the schematic as it stands, without the border, e.g. to check the running
+		// results against a full solve
+		std::vector<std::string> lines() const;
+
+		// label the digit runs of row within cols [lo, hi], the runs must not extend
+		// past either end of the span
+		void label_span(const size_t row, const size_t lo, const size_t hi);
+
+		bool is_part(const uint32_t label) const;
+
+		// number of distinct numbers around the symbol at i, and their product
+		std::pair<size_t, uint64_t> neighbours(const size_t i) const;
+
+		// add (sign = +1) or remove (sign = -1) the contribution of every number and
+		// symbol touching rows row - 1 to row + 1, cols lo - 1 to hi + 1
+		void accumulate(const size_t row, const size_t lo, const size_t hi,
+		                const int sign);
+} mutable_schematic_t;
+
+void
+MutableSchematic::label_span(const size_t row, const size_t lo, const size_t hi) {
+	for (size_t col = lo; col <= hi;) {
+		if (!schematic::is_digit(at(row, col))) {
+			col++;
+			continue;
+		}
+
+		uint32_t label;
+		if (free_labels.empty()) {
+			numbers.push_back({});
+			label = (uint32_t) numbers.size();
+		} else {
+			label = free_labels.back();
+			free_labels.pop_back();
+		}
+
+		entry_t &n = numbers[label - 1];
+		n = {0, (uint32_t) row, (uint32_t) col, (uint32_t) col};
+
+		for (; col <= hi && schematic::is_digit(at(row, col)); col++) {
+			n.v = n.v * 10 + (uint64_t) (at(row, col) - '0');
+			n.end = (uint32_t) col;
+			labels[index(col, row)] = label;
+		}
+	}
+}
+
+bool
+MutableSchematic::is_part(const uint32_t label) const {
+	const entry_t &n = numbers[label - 1];
+
+	for (size_t r = n.row; r <= (size_t) n.row + 2; r++) {
+		for (size_t c = n.start; c <= (size_t) n.end + 2; c++) {
+			// (r, c) are in bordered coordinates, i.e. already offset by one
+			if (schematic::is_symbol(cells[r * width + c])) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+std::pair<size_t, uint64_t>
+MutableSchematic::neighbours(const size_t i) const {
+	const ssize_t w = (ssize_t) width;
+	const std::array<ssize_t, 8> offsets{-w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1};
+
+	std::array<uint32_t, 8> adjacent{};
+	size_t n_adjacent = 0;
+	uint64_t product = 1;
+
+	for (auto offset : offsets) {
+		auto label = labels[i + offset];
+		if (label == label_grid::NO_LABEL ||
+		    std::find(adjacent.begin(), adjacent.begin() + n_adjacent, label) !=
+		        adjacent.begin() + n_adjacent) {
+			continue;
+		}
+		adjacent[n_adjacent++] = label;
+		product *= numbers[label - 1].v;
+	}
+
+	return {n_adjacent, product};
+}
+
+void
+MutableSchematic::accumulate(const size_t row, const size_t lo, const size_t hi,
+                             const int sign) {
+	const size_t r0 = row > 0 ? row - 1 : 0;
+	const size_t r1 = std::min(row + 1, n_rows() - 1);
+	const size_t c0 = lo > 0 ? lo - 1 : 0;
+	const size_t c1 = std::min(hi + 1, n_cols() - 1);
+
+	// a number can cross the region several times only along its own row, so
+	// remembering the last label seen on each row is enough to dedupe
+	for (size_t r = r0; r <= r1; r++) {
+		uint32_t last = label_grid::NO_LABEL;
+
+		for (size_t c = c0; c <= c1; c++) {
+			const size_t i = index(c, r);
+			const auto label = labels[i];
+
+			if (label != label_grid::NO_LABEL && label != last && is_part(label)) {
+				results.n_engine_parts += sign;
+				results.part_sum += sign * numbers[label - 1].v;
+			}
+			last = label;
+
+			if (schematic::is_symbol(cells[i])) {
+				auto [n_adjacent, product] = neighbours(i);
+				if (n_adjacent == 2) {
+					results.gear_ratio_sum += sign * product;
+				}
+			}
+		}
+	}
+}
+
+bool
+MutableSchematic::apply_edit(const size_t row, const size_t col, const char c) {
+	if (row >= n_rows() || col >= n_cols()) {
+		return false;
+	}
+
+	// span of the numbers on this row that the edit can reshape
+	size_t lo = col;
+	size_t hi = col;
+	for (size_t x = col > 0 ? col - 1 : 0; x <= std::min(col + 1, n_cols() - 1); x++) {
+		const auto label = labels[index(x, row)];
+		if (label != label_grid::NO_LABEL) {
+			lo = std::min(lo, (size_t) numbers[label - 1].start);
+			hi = std::max(hi, (size_t) numbers[label - 1].end);
+		}
+	}
+
+	accumulate(row, lo, hi, -1);
+
+	for (size_t x = lo; x <= hi; x++) {
+		auto &label = labels[index(x, row)];
+		if (label != label_grid::NO_LABEL && numbers[label - 1].start == x) {
+			free_labels.push_back(label);
+		}
+		label = label_grid::NO_LABEL;
+	}
+
+	cells[index(col, row)] = c;
+	label_span(row, lo, hi);
+
+	accumulate(row, lo, hi, +1);
+
+	return true;
+}
+
+std::vector<std::string>
+MutableSchematic::lines() const {
+	std::vector<std::string> out;
+	out.reserve(n_rows());
+
+	for (size_t row = 0; row < n_rows(); row++) {
+		const auto first = cells.begin() + (ptrdiff_t) index(0, row);
+		out.emplace_back(first, first + (ptrdiff_t) n_cols());
+	}
+
+	return out;
+}
+
+// "ROW,COL,C", e.g. "4,17,*", empty if s isn't one
+inline std::optional<edit_t>
+parse_edit(const std::string_view s) {
+	// exactly one character after the second comma
+	const auto first = s.find(',');
+	if (first == std::string_view::npos || s.size() < first + 4 ||
+	    s[s.size() - 2] != ',') {
+		return std::nullopt;
+	}
+
+	const auto row = s.substr(0, first);
+	const auto col = s.substr(first + 1, s.size() - 2 - (first + 1));
+
+	// every character of each must be a digit
+	edit_t edit{0, 0, s.back()};
+	uint64_t value = 0;
+	if (row.empty() || scan::parse_uint(row, value) != row.data() + row.size()) {
+		return std::nullopt;
+	}
+	edit.row = value;
+	if (col.empty() || scan::parse_uint(col, value) != col.data() + col.size()) {
+		return std::nullopt;
+	}
+	edit.col = value;
+
+	return edit;
+}
+
+mutable_schematic_t
+build(const std::vector<std::string_view> &data) {
+	INSTRUMENT_PHASE("solve (incremental)");
+
+	size_t n_cols = 0;
+	for (const auto &line : data) {
+		n_cols = std::max(n_cols, line.length());
+	}
+
+	mutable_schematic_t schematic{n_cols + 2,
+	                              data.size() + 2,
+	                              std::pmr::vector<char>(pages::resource()),
+	                              std::pmr::vector<uint32_t>(pages::resource()),
+	                              {},
+	                              {},
+	                              {0, 0, 0}};
+	schematic.cells.assign(schematic.width * schematic.height, '.');
+	schematic.labels.assign(schematic.width * schematic.height, label_grid::NO_LABEL);
+
+	if (n_cols == 0) {
+		return schematic;
+	}
+
+	for (size_t row = 0; row < data.size(); row++) {
+		const auto &line = data.at(row);
+		std::copy(line.begin(), line.end(),
+		          schematic.cells.begin() + schematic.index(0, row));
+		schematic.label_span(row, 0, n_cols - 1);
+	}
+
+	for (uint32_t label = 1; label <= schematic.numbers.size(); label++) {
+		if (schematic.is_part(label)) {
+			schematic.results.n_engine_parts++;
+			schematic.results.part_sum += schematic.numbers[label - 1].v;
+		}
+	}
+
+	for (size_t i = 0; i < schematic.cells.size(); i++) {
+		if (schematic::is_symbol(schematic.cells[i])) {
+			auto [n_adjacent, product] = schematic.neighbours(i);
+			if (n_adjacent == 2) {
+				schematic.results.gear_ratio_sum += product;
+			}
+		}
+	}
+
+	return schematic;
+}
+
+}   // namespace incremental
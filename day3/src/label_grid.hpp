@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "../../common/pages.hpp"
+#include "schematic.hpp"
+
+namespace label_grid {
+
+// Rather than comparing every number against every symbol (O(|N| * |S|)) paint each
+// number's id over the cells it covers, then a symbol only has to read its 8
+// neighbouring cells to find which numbers touch it.
+//
+// The grid has a one cell border of empty cells so neighbour reads never need a bounds
+// check. It comes from pages::resource(), so is on huge pages with AOC_HUGE_PAGES.
+
+constexpr uint32_t NO_LABEL = 0;   // label = index into schematic.number_values + 1
+
+typedef struct LabelGrid {
+		size_t width;    // including border
+		size_t height;   // including border
+		std::pmr::vector<uint32_t> labels;
+		std::pmr::vector<char> symbols;   // '\0' where there is no symbol
+
+		inline size_t index(const size_t col, const size_t row) const {
+			return (row + 1) * width + (col + 1);
+		};
+} label_grid_t;
+
+label_grid_t
+build(const schematic::schematic_t &schematic,
+      std::pmr::memory_resource *resource = pages::resource()) {
+	label_grid_t grid{schematic.width + 2, schematic.height + 2,
+	                  std::pmr::vector<uint32_t>(resource), std::pmr::vector<char>(resource)};
+	grid.labels.assign(grid.width * grid.height, NO_LABEL);
+	grid.symbols.assign(grid.width * grid.height, '\0');
+
+	for (size_t i = 0; i < schematic.n_numbers(); i++) {
+		const size_t row = schematic.number_rows[i];
+		for (size_t col = schematic.number_start_cols[i];
+		     col <= schematic.number_end_cols[i]; col++) {
+			grid.labels[grid.index(col, row)] = (uint32_t) i + 1;
+		}
+	}
+
+	for (size_t i = 0; i < schematic.n_symbols(); i++) {
+		grid.symbols[grid.index(schematic.symbol_cols[i], schematic.symbol_rows[i])] =
+		    schematic.symbol_chars[i];
+	}
+
+	return grid;
+}
+
+// only numbers and gears on rows [owned_from, owned_to) are counted, the rows either
+// side are still read so that a tile of a larger schematic can see its neighbours
+schematic::results_t
+solve(const schematic::schematic_t &schematic, const size_t owned_from,
+      const size_t owned_to) {
+	INSTRUMENT_PHASE("solve (label-grid)");
+
+	auto grid = build(schematic);
+
+	std::vector<bool> is_part(schematic.n_numbers() + 1, false);
+	schematic::results_t results{0, 0, 0};
+
+	// a cell has at most 6 distinct neighbouring numbers (2 above, 2 below, 1 either
+	// side) as numbers on the same row must be separated by at least one cell
+	std::array<uint32_t, 8> adjacent{};
+
+	const ssize_t w = (ssize_t) grid.width;
+	const std::array<ssize_t, 8> offsets{-w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1};
+
+	INSTRUMENT_NO_ALLOCATIONS("label-grid sweep");
+
+	for (size_t i = grid.width; i < grid.labels.size() - grid.width; i++) {
+		if (grid.symbols[i] == '\0') {
+			continue;
+		}
+
+		const size_t row = i / grid.width - 1;
+		const bool is_owned = owned_from <= row && row < owned_to;
+
+		size_t n_adjacent = 0;
+		for (auto offset : offsets) {
+			auto label = grid.labels[i + offset];
+			if (label == NO_LABEL) {
+				continue;
+			}
+
+			// a number spanning several neighbouring cells is only counted once
+			if (std::find(adjacent.begin(), adjacent.begin() + n_adjacent, label) !=
+			    adjacent.begin() + n_adjacent) {
+				continue;
+			}
+			adjacent[n_adjacent++] = label;
+
+			const size_t number_row = schematic.number_rows[label - 1];
+			if (number_row < owned_from || owned_to <= number_row) {
+				continue;
+			}
+
+			if (!is_part[label]) {
+				is_part[label] = true;
+				results.n_engine_parts++;
+				results.part_sum += schematic.number_values[label - 1];
+			}
+		}
+
+		if (is_owned && n_adjacent == 2) {
+			results.gear_ratio_sum += schematic.number_values[adjacent[0] - 1] *
+			                          schematic.number_values[adjacent[1] - 1];
+		}
+	}
+
+	return results;
+}
+
+schematic::results_t
+solve(const schematic::schematic_t &schematic) {
+	return solve(schematic, 0, schematic.height);
+}
+
+}   // namespace label_grid
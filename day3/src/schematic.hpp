@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "../../common/scan.hpp"
+#include "classify.hpp"
+
+namespace schematic {
+
+// Coordinates are 32 bit and numbers may be any number of digits long, values are held
+// as 64 bit so are exact up to 19 digits. The schematic stores each field in its own
+// array (struct-of-arrays) which keeps a symbol at 9 bytes and a number at 20 bytes,
+// so a 10k x 10k grid of a few million elements stays at tens of megabytes.
+
+typedef struct Position {
+		const uint32_t col;
+		const uint32_t row;
+} position_t;
+
+typedef struct Symbol {
+		const char c;
+		const position_t pos;
+} symbol_t;
+
+typedef struct Number {
+		const uint64_t v;   // exact up to 19 digits, longer runs wrap (see scan.hpp)
+		const position_t start;
+		const position_t end;
+} number_t;
+
+typedef struct Schematic {
+		size_t width = 0;
+		size_t height = 0;
+		size_t n_unrecognised = 0;   // characters skipped as if they were '.'
+
+		std::pmr::vector<char> symbol_chars;
+		std::pmr::vector<uint32_t> symbol_cols;
+		std::pmr::vector<uint32_t> symbol_rows;
+
+		// numbers never span rows, so one row is stored for both ends
+		std::pmr::vector<uint64_t> number_values;
+		std::pmr::vector<uint32_t> number_rows;
+		std::pmr::vector<uint32_t> number_start_cols;
+		std::pmr::vector<uint32_t> number_end_cols;
+
+		explicit Schematic(
+		    std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+		    : symbol_chars(resource), symbol_cols(resource), symbol_rows(resource),
+		      number_values(resource), number_rows(resource), number_start_cols(resource),
+		      number_end_cols(resource) {
+		}
+
+		inline size_t n_symbols() const {
+			return symbol_chars.size();
+		};
+
+		inline size_t n_numbers() const {
+			return number_values.size();
+		};
+
+		inline symbol_t symbol(const size_t i) const {
+			return {symbol_chars[i], {symbol_cols[i], symbol_rows[i]}};
+		};
+
+		inline number_t number(const size_t i) const {
+			return {number_values[i],
+			        {number_start_cols[i], number_rows[i]},
+			        {number_end_cols[i], number_rows[i]}};
+		};
+
+		inline auto symbols() const {
+			return std::views::iota((size_t) 0, n_symbols()) |
+			       std::views::transform([this](size_t i) { return symbol(i); });
+		};
+
+		inline auto numbers() const {
+			return std::views::iota((size_t) 0, n_numbers()) |
+			       std::views::transform([this](size_t i) { return number(i); });
+		};
+
+		inline void push_symbol(const symbol_t s) {
+			symbol_chars.push_back(s.c);
+			symbol_cols.push_back(s.pos.col);
+			symbol_rows.push_back(s.pos.row);
+		};
+
+		inline void push_number(const number_t n) {
+			number_values.push_back(n.v);
+			number_rows.push_back(n.start.row);
+			number_start_cols.push_back(n.start.col);
+			number_end_cols.push_back(n.end.col);
+		};
+} schematic_t;
+
+typedef struct Results {
+		uint64_t n_engine_parts;
+		uint64_t part_sum;
+		uint64_t gear_ratio_sum;
+} results_t;
+
+inline constexpr bool
+is_noop(const char c) {
+	return c == '.';
+}
+
+inline constexpr bool
+is_symbol(const char c) {
+	return c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '$' ||
+	       c == '=' || c == '&' || c == '@' || c == '#';
+}
+
+inline constexpr bool
+is_digit(const char c) {
+	// I could use isdigit(...) but this is consistent with the others
+	return '0' <= c && c <= '9';
+}
+
+// parse rows [from, to) of data, rows in the schematic are relative to from, its arrays
+// are allocated from resource
+//
+// Each row is classified 64 bytes at a time (see classify.hpp), then only the symbols
+// and the first digit of each number are visited. A number is read with
+// scan::parse_uint from its first digit, so it may run on into the next block.
+std::unique_ptr<const schematic_t>
+parse(const std::vector<std::string_view> &data, const size_t from, const size_t to,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	INSTRUMENT_PHASE("parse");
+	INSTRUMENT_COUNT("lines parsed", to - from);
+
+	auto schematic = std::make_unique<schematic_t>(resource);
+	schematic->height = to - from;
+
+	size_t n_unrecognised = 0;
+	const auto classify = classify::kernel();
+
+	for (uint32_t row = 0; row < to - from; row++) {
+		const auto &line = data.at(from + row);
+		schematic->width = std::max(schematic->width, line.length());
+
+		// whether the last byte of the previous block was a digit
+		uint64_t carry = 0;
+
+		for (uint32_t block = 0; block < line.length(); block += 64) {
+			const size_t n = std::min(line.length() - block, (size_t) 64);
+			const auto masks = classify(line.data() + block, n);
+
+			const uint64_t all = n == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+			n_unrecognised +=
+			    (size_t) std::popcount(all & ~(masks.digits | masks.symbols | masks.dots));
+
+			for (uint64_t symbols = masks.symbols; symbols != 0; symbols &= symbols - 1) {
+				const uint32_t col = block + (uint32_t) std::countr_zero(symbols);
+				schematic->push_symbol({line[col], {col, row}});
+			}
+
+			uint64_t starts = masks.digits & ~((masks.digits << 1) | carry);
+			for (; starts != 0; starts &= starts - 1) {
+				const uint32_t col = block + (uint32_t) std::countr_zero(starts);
+
+				uint64_t v = 0;
+				const char *end = scan::parse_uint(line.substr(col), v);
+				const uint32_t col_ = (uint32_t) (end - line.data());
+
+				schematic->push_number({v, {col, row}, {col_ - 1, row}});
+			}
+
+			carry = masks.digits >> 63;
+		}
+	}
+
+	// left to the caller to report, which may have parsed the rows in several pieces
+	schematic->n_unrecognised = n_unrecognised;
+
+	return schematic;
+}
+
+// once for the whole schematic rather than for every byte
+inline void
+warn_unrecognised(const size_t n_unrecognised) {
+	if (n_unrecognised > 0) {
+		std::cout << "warning: skipped " << n_unrecognised << " unrecognised characters"
+		          << std::endl;
+	}
+}
+
+// as parse counts them, for a caller that needs one row's share
+inline size_t
+count_unrecognised(const std::string_view line) {
+	const auto classify = classify::kernel();
+
+	size_t n_unrecognised = 0;
+	for (size_t block = 0; block < line.length(); block += 64) {
+		const size_t n = std::min(line.length() - block, (size_t) 64);
+		const auto masks = classify(line.data() + block, n);
+
+		const uint64_t all = n == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+		n_unrecognised +=
+		    (size_t) std::popcount(all & ~(masks.digits | masks.symbols | masks.dots));
+	}
+
+	return n_unrecognised;
+}
+
+std::unique_ptr<const schematic_t>
+parse(const std::vector<std::string_view> &data,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	auto schematic = parse(data, 0, data.size(), resource);
+	warn_unrecognised(schematic->n_unrecognised);
+	return schematic;
+}
+
+// value of the number covering col in line, col must be a digit
+inline uint64_t
+number_at(const std::string_view line, size_t col) {
+	// walk back to the start of the run then read forward
+	while (col > 0 && is_digit(line[col - 1])) {
+		col--;
+	}
+
+	uint64_t v = 0;
+	scan::parse_uint(line.substr(col), v);
+
+	return v;
+}
+
+inline bool
+is_adjacent(const symbol_t s, const number_t n) {
+	// cast to signed to avoid overflow/underflow
+	int64_t x0 = (int64_t) n.start.col - 1;
+	int64_t y0 = (int64_t) n.start.row - 1;
+	int64_t x1 = (int64_t) n.end.col + 1;
+	int64_t y1 = (int64_t) n.end.row + 1;
+
+	return ((x0 <= s.pos.col && s.pos.col <= x1) &&
+	        (y0 <= s.pos.row && s.pos.row <= y1));
+}
+
+inline bool
+is_engine_part(const schematic_t &schematic, const number_t n) {
+	return std::ranges::any_of(schematic.symbols(),
+	                           [n](const auto &s) { return is_adjacent(s, n); });
+}
+
+std::unique_ptr<std::vector<number_t>>
+find_engine_parts(const schematic_t &schematic) {
+	INSTRUMENT_PHASE("solve (part one)");
+
+	auto parts = std::make_unique<std::vector<number_t>>();
+
+	for (auto n : schematic.numbers()) {
+		if (is_engine_part(schematic, n)) {
+			parts->push_back(n);
+		}
+	}
+
+	return parts;
+}
+
+inline bool
+is_gear(const schematic_t &schematic, const symbol_t s) {
+	size_t n_adjacent_numbers = std::ranges::count_if(
+	    schematic.numbers(), [s](const auto &n) { return is_adjacent(s, n); });
+	return n_adjacent_numbers == 2;
+}
+
+uint64_t
+calc_gear_ratio(const std::vector<number_t> &numbers) {
+	uint64_t product{1};
+
+	for (auto n : numbers) {
+		product *= (uint64_t) n.v;
+	}
+
+	return product;
+}
+
+std::unique_ptr<std::vector<number_t>>
+find_adjacent_numbers(const schematic_t &schematic, const symbol_t s) {
+	auto numbers = std::make_unique<std::vector<number_t>>();
+
+	for (auto n : schematic.numbers()) {
+		if (is_adjacent(s, n)) {
+			numbers->push_back(n);
+		}
+	}
+
+	return numbers;
+}
+
+std::unique_ptr<std::vector<uint64_t>>
+find_gear_ratios(const schematic_t &schematic) {
+	INSTRUMENT_PHASE("solve (part two)");
+
+	auto gears_ratios = std::make_unique<std::vector<uint64_t>>();
+
+	for (auto s : schematic.symbols()) {
+		if (!is_gear(schematic, s))
+			continue;
+		gears_ratios->push_back(calc_gear_ratio(*find_adjacent_numbers(schematic, s)));
+	}
+
+	return gears_ratios;
+}
+
+uint64_t
+sum_engine_part_values(const std::vector<number_t> &parts) {
+	uint64_t sum{0};
+
+	for (auto p : parts) {
+		sum += (uint64_t) p.v;
+	}
+
+	return sum;
+}
+
+results_t
+solve(const schematic_t &schematic) {
+	auto parts = find_engine_parts(schematic);
+	auto gear_ratios = find_gear_ratios(schematic);
+
+	uint64_t gear_ratio_sum{0};
+	for (auto r : *gear_ratios) {
+		gear_ratio_sum += r;
+	}
+
+	return {parts->size(), sum_engine_part_values(*parts), gear_ratio_sum};
+}
+
+}   // namespace schematic
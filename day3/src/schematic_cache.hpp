@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "../../common/cache.hpp"
+#include "../../common/input.hpp"
+#include "schematic.hpp"
+
+namespace schematic_cache {
+
+// The schematic's arrays as they are in memory, one cache section each:
+//   0  width, height, characters skipped as unrecognised
+//   1  symbol chars, 2  symbol cols, 3  symbol rows
+//   4  number values, 5  number rows, 6  number start cols, 7  number end cols
+
+constexpr uint32_t DAY = 3;
+constexpr uint32_t VERSION = 2;   // bump when the sections above change
+
+bool
+save(const schematic::schematic_t &schematic, const uint64_t input_hash) {
+	const std::array<uint64_t, 3> dimensions{schematic.width, schematic.height,
+	                                         schematic.n_unrecognised};
+
+	cache::writer_t writer;
+	writer.add(std::span<const uint64_t>(dimensions));
+	writer.add(std::span<const char>(schematic.symbol_chars));
+	writer.add(std::span<const uint32_t>(schematic.symbol_cols));
+	writer.add(std::span<const uint32_t>(schematic.symbol_rows));
+	writer.add(std::span<const uint64_t>(schematic.number_values));
+	writer.add(std::span<const uint32_t>(schematic.number_rows));
+	writer.add(std::span<const uint32_t>(schematic.number_start_cols));
+	writer.add(std::span<const uint32_t>(schematic.number_end_cols));
+
+	return writer.write(DAY, VERSION, input_hash);
+}
+
+std::unique_ptr<const schematic::schematic_t>
+load(const cache::reader_t &reader, std::pmr::memory_resource *resource) {
+	INSTRUMENT_PHASE("cache (load)");
+
+	const auto dimensions = reader.array<uint64_t>(0);
+	if (!dimensions.has_value() || dimensions->size() != 3) {
+		return nullptr;
+	}
+
+	auto schematic = std::make_unique<schematic::schematic_t>(resource);
+	schematic->width = (*dimensions)[0];
+	schematic->height = (*dimensions)[1];
+	schematic->n_unrecognised = (*dimensions)[2];
+
+	if (!reader.copy_to<char>(1, schematic->symbol_chars) ||
+	    !reader.copy_to<uint32_t>(2, schematic->symbol_cols) ||
+	    !reader.copy_to<uint32_t>(3, schematic->symbol_rows) ||
+	    !reader.copy_to<uint64_t>(4, schematic->number_values) ||
+	    !reader.copy_to<uint32_t>(5, schematic->number_rows) ||
+	    !reader.copy_to<uint32_t>(6, schematic->number_start_cols) ||
+	    !reader.copy_to<uint32_t>(7, schematic->number_end_cols)) {
+		return nullptr;
+	}
+
+	const size_t n_symbols = schematic->n_symbols();
+	const size_t n_numbers = schematic->n_numbers();
+	if (schematic->symbol_cols.size() != n_symbols ||
+	    schematic->symbol_rows.size() != n_symbols ||
+	    schematic->number_rows.size() != n_numbers ||
+	    schematic->number_start_cols.size() != n_numbers ||
+	    schematic->number_end_cols.size() != n_numbers) {
+		return nullptr;
+	}
+
+	// the grid engines index width x height arrays by these without checking, so a
+	// damaged file (or a hash collision) must not get this far
+	const size_t width = schematic->width;
+	const size_t height = schematic->height;
+	for (size_t i = 0; i < n_symbols; i++) {
+		if (schematic->symbol_cols[i] >= width || schematic->symbol_rows[i] >= height) {
+			return nullptr;
+		}
+	}
+	for (size_t i = 0; i < n_numbers; i++) {
+		if (schematic->number_rows[i] >= height ||
+		    schematic->number_end_cols[i] >= width ||
+		    schematic->number_start_cols[i] > schematic->number_end_cols[i]) {
+			return nullptr;
+		}
+	}
+
+	return schematic;
+}
+
+// from the cache when AOC_CACHE is set and there is one for these contents, otherwise
+// parsed from the lines lines_of() returns, only asked for on a miss, and then cached
+// when AOC_CACHE is set. Warns about unrecognised characters either way.
+template <typename F>
+std::unique_ptr<const schematic::schematic_t>
+parse_with(const std::string_view contents, F lines_of,
+           std::pmr::memory_resource *resource) {
+	const bool enabled = cache::enabled();
+	const uint64_t input_hash = enabled ? cache::hash(contents) : 0;
+
+	std::unique_ptr<const schematic::schematic_t> schematic;
+	if (enabled) {
+		if (auto reader = cache::open(DAY, VERSION, input_hash)) {
+			schematic = load(*reader, resource);
+		}
+	}
+
+	if (schematic == nullptr) {
+		const auto &data = lines_of();
+		schematic = schematic::parse(data, 0, data.size(), resource);
+		if (enabled) {
+			save(*schematic, input_hash);
+		}
+	}
+
+	schematic::warn_unrecognised(schematic->n_unrecognised);
+
+	return schematic;
+}
+
+// the lines of contents are only collected if they have to be parsed
+std::unique_ptr<const schematic::schematic_t>
+parse(const std::string_view contents,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	return parse_with(
+	    contents, [&]() { return input::collect(input::lines_t{contents}); }, resource);
+}
+
+// for a caller which has collected the lines (data) anyway
+std::unique_ptr<const schematic::schematic_t>
+parse(const std::string_view contents, const std::vector<std::string_view> &data,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	return parse_with(
+	    contents, [&]() -> const std::vector<std::string_view> & { return data; },
+	    resource);
+}
+
+}   // namespace schematic_cache
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../../common/input.hpp"
+#include "../../common/instrument.hpp"
+#include "../../common/scan.hpp"
+#include "schematic.hpp"
+
+namespace streaming {
+
+// Solve a schematic read line by line keeping only three rows in memory, so memory is
+// O(width) however tall the schematic is. Once the row below has been read the middle
+// row is final: its numbers and symbols can see every neighbour they will ever have.
+
+typedef struct RowResults {
+		size_t row;
+		uint64_t n_engine_parts;
+		uint64_t part_sum;
+		uint64_t gear_ratio_sum;
+} row_results_t;
+
+inline char
+cell(const std::string_view line, const ssize_t col) {
+	if (col < 0 || (size_t) col >= line.length()) {
+		return '.';
+	}
+	return line[col];
+}
+
+row_results_t
+finalise_row(const std::string_view above, const std::string_view middle,
+             const std::string_view below, const size_t row) {
+	row_results_t results{row, 0, 0, 0};
+	const std::array<std::string_view, 3> window{above, middle, below};
+
+	for (size_t col = 0; col < middle.length();) {
+		const char c = middle[col];
+
+		if (schematic::is_digit(c)) {
+			uint64_t v = 0;
+			const size_t end =
+			    (size_t) (scan::parse_uint(middle.substr(col), v) - middle.data());
+
+			bool is_part = false;
+			for (auto line : window) {
+				for (ssize_t x = (ssize_t) col - 1; x <= (ssize_t) end && !is_part; x++) {
+					is_part = schematic::is_symbol(cell(line, x));
+				}
+			}
+
+			if (is_part) {
+				results.n_engine_parts++;
+				results.part_sum += v;
+			}
+
+			col = end;
+			continue;
+		}
+
+		if (schematic::is_symbol(c)) {
+			// see bitboard::solve, count the digit runs starting in the 3x3 window
+			size_t n_adjacent = 0;
+			uint64_t ratio = 1;
+
+			for (auto line : window) {
+				for (ssize_t x = (ssize_t) col - 1; x <= (ssize_t) col + 1; x++) {
+					if (!schematic::is_digit(cell(line, x))) {
+						continue;
+					}
+					if (x != (ssize_t) col - 1 && schematic::is_digit(cell(line, x - 1))) {
+						continue;
+					}
+
+					n_adjacent++;
+					ratio *= schematic::number_at(line, x);
+				}
+			}
+
+			if (n_adjacent == 2) {
+				results.gear_ratio_sum += ratio;
+			}
+		}
+
+		col++;
+	}
+
+	return results;
+}
+
+inline void
+add_row(schematic::results_t &results, const row_results_t &row,
+        const std::function<void(const row_results_t &)> &on_row) {
+	results.n_engine_parts += row.n_engine_parts;
+	results.part_sum += row.part_sum;
+	results.gear_ratio_sum += row.gear_ratio_sum;
+	INSTRUMENT_COUNT("lines parsed", 1);
+
+	if (on_row) {
+		on_row(row);
+	}
+}
+
+// lines of a mapped file, the window is three views into the mapping
+schematic::results_t
+solve(const input::lines_t &lines,
+      const std::function<void(const row_results_t &)> &on_row = {}) {
+	INSTRUMENT_PHASE("solve (stream)");
+
+	schematic::results_t results{0, 0, 0};
+
+	// above, middle, below
+	std::array<std::string_view, 3> window{};
+	size_t n_rows = 0;
+
+	size_t n_unrecognised = 0;
+
+	for (auto line : lines) {
+		window[2] = line;
+		n_unrecognised += schematic::count_unrecognised(line);
+		if (n_rows > 0) {
+			add_row(results, finalise_row(window[0], window[1], window[2], n_rows - 1),
+			        on_row);
+		}
+
+		window[0] = window[1];
+		window[1] = window[2];
+		n_rows++;
+	}
+
+	if (n_rows > 0) {
+		add_row(results, finalise_row(window[0], window[1], {}, n_rows - 1), on_row);
+	}
+
+	// once the last row is out, as the count isn't known before then
+	schematic::warn_unrecognised(n_unrecognised);
+
+	return results;
+}
+
+// lines read from a stream (e.g. a pipe) which can't be mapped
+schematic::results_t
+solve(std::istream &input, const std::function<void(const row_results_t &)> &on_row = {}) {
+	INSTRUMENT_PHASE("solve (stream)");
+
+	schematic::results_t results{0, 0, 0};
+
+	// above, middle, below, rotated so each string's buffer is reused
+	std::array<std::string, 3> window{};
+	size_t n_rows = 0;
+
+	size_t n_unrecognised = 0;
+
+	while (std::getline(input, window[2])) {
+		n_unrecognised += schematic::count_unrecognised(window[2]);
+		if (n_rows > 0) {
+			add_row(results, finalise_row(window[0], window[1], window[2], n_rows - 1),
+			        on_row);
+		}
+
+		std::swap(window[0], window[1]);
+		std::swap(window[1], window[2]);
+		n_rows++;
+	}
+
+	if (n_rows > 0) {
+		add_row(results, finalise_row(window[0], window[1], {}, n_rows - 1), on_row);
+	}
+
+	// once the last row is out, as the count isn't known before then
+	schematic::warn_unrecognised(n_unrecognised);
+
+	return results;
+}
+
+// "-" reads from stdin so schematics can be piped through
+std::optional<schematic::results_t>
+solve_file(const std::filesystem::path &filepath,
+           const std::function<void(const row_results_t &)> &on_row = {}) {
+	if (filepath == "-") {
+		return solve(std::cin, on_row);
+	}
+
+	auto file = input::map_file(filepath);
+
+	if (!file.has_value()) {
+		return std::nullopt;
+	}
+
+	return solve(file->lines(), on_row);
+}
+
+}   // namespace streaming
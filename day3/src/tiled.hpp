@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <omp.h>
+
+#include "../../common/instrument.hpp"
+#include "../../common/pool.hpp"
+#include "label_grid.hpp"
+#include "schematic.hpp"
+
+namespace tiled {
+
+// Split the schematic into horizontal tiles which are parsed and solved in parallel.
+// Each tile also parses one halo row above and below it so symbols and numbers on its
+// edge rows can see their neighbours. A tile only counts the numbers and gears on its
+// own rows (halo rows belong to the tile either side), so merging is a plain sum and
+// nothing crossing a tile edge is counted twice.
+
+schematic::results_t
+solve(const std::vector<std::string_view> &data, size_t n_tiles = 0) {
+	INSTRUMENT_PHASE("solve (tiled)");
+
+	if (n_tiles == 0) {
+		n_tiles = (size_t) omp_get_max_threads();
+	}
+	n_tiles = std::max((size_t) 1, std::min(n_tiles, data.size()));
+
+	const size_t tile_height = (data.size() + n_tiles - 1) / n_tiles;
+	std::vector<schematic::results_t> tile_results(n_tiles, {0, 0, 0});
+
+	std::vector<size_t> tile_unrecognised(n_tiles, 0);
+
+	// by pointer, the tasks would otherwise each get a private copy of the vectors
+	schematic::results_t *out = tile_results.data();
+	size_t *unrecognised = tile_unrecognised.data();
+
+	pool::run([&]() {
+#pragma omp taskloop grainsize(1) firstprivate(out, unrecognised)
+		for (size_t t = 0; t < n_tiles; t++) {
+			const size_t first = t * tile_height;
+			const size_t last = std::min(data.size(), first + tile_height);
+			if (first >= last) {
+				continue;
+			}
+
+			const size_t from = first > 0 ? first - 1 : 0;
+			const size_t to = std::min(data.size(), last + 1);
+
+			auto schematic = schematic::parse(data, from, to);
+			out[t] = label_grid::solve(*schematic, first - from, last - from);
+
+			// the halo rows are counted by the tiles they belong to
+			unrecognised[t] = schematic->n_unrecognised;
+			if (from < first) {
+				unrecognised[t] -= schematic::count_unrecognised(data[from]);
+			}
+			if (to > last) {
+				unrecognised[t] -= schematic::count_unrecognised(data[to - 1]);
+			}
+		}
+	});
+
+	// one warning for the whole schematic, after every tile has finished
+	size_t n_unrecognised = 0;
+	for (auto n : tile_unrecognised) {
+		n_unrecognised += n;
+	}
+	schematic::warn_unrecognised(n_unrecognised);
+
+	// merge
+	schematic::results_t results{0, 0, 0};
+	for (auto r : tile_results) {
+		results.n_engine_parts += r.n_engine_parts;
+		results.part_sum += r.part_sum;
+		results.gear_ratio_sum += r.gear_ratio_sum;
+	}
+
+	return results;
+}
+
+}   // namespace tiled
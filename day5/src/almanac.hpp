@@ -1,10 +1,18 @@
 #pragma once
 
+#include <array>
+#include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
-#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "../../common/instrument.hpp"
+#include "../../common/scan.hpp"
+
 namespace almanac {
 
 // NOTE
@@ -17,39 +25,41 @@ typedef struct input_map_rule {
 		const size_t dest;
 		const size_t range;
 
-		inline size_t max_source_index() {
+		inline size_t max_source_index() const {
 			return source + range - 1;
 		};
 
-		inline size_t max_dest_index() {
+		inline size_t max_dest_index() const {
 			return dest + range - 1;
 		};
 
-		inline bool is_in_range(const size_t index) {
+		inline bool is_in_range(const size_t index) const {
 			return source <= index && index <= max_source_index();
 		};
 
-		inline size_t map(const size_t index) {
+		inline size_t map(const size_t index) const {
 			return dest - source + index;
 		};
 } input_map_rule_t;
 
 typedef struct input_map {
-		const std::vector<input_map_rule_t> rules;
+		const std::pmr::vector<input_map_rule_t> rules;
 
-		inline size_t map(const size_t index) {
+		inline size_t map(const size_t index) const {
 			for (ssize_t i = rules.size() - 1; i >= 0; i--) {
-				auto rule = rules.at(i);
+				const auto &rule = rules.at(i);
 				if (rule.is_in_range(index)) {
+					INSTRUMENT_COUNT("rules evaluated", rules.size() - i);
 					return rule.map(index);
 				}
 			}
+			INSTRUMENT_COUNT("rules evaluated", rules.size());
 			return index;
 		};
 } input_map_t;
 
 typedef struct input_almanac_maps {
-		const std::vector<size_t> initial_seeds;
+		const std::pmr::vector<size_t> initial_seeds;
 		const input_map_t seed_to_soil_map;
 		const input_map_t soil_to_fertilizer_map;
 		const input_map_t fertilizer_to_water_map;
@@ -59,6 +69,20 @@ typedef struct input_almanac_maps {
 		const input_map_t humidity_to_location_map;
 } input_almanac_maps_t;
 
+constexpr size_t N_MAPS = 7;
+
+// in the order a seed goes through them
+inline std::array<const input_map_t *, N_MAPS>
+maps_of(const input_almanac_maps_t &maps) {
+	return {&maps.seed_to_soil_map,
+	        &maps.soil_to_fertilizer_map,
+	        &maps.fertilizer_to_water_map,
+	        &maps.water_to_light_map,
+	        &maps.light_to_temperature_map,
+	        &maps.temperature_to_humidity_map,
+	        &maps.humidity_to_location_map};
+}
+
 typedef struct seed_range {
 		const size_t start;
 		const size_t range;
@@ -68,48 +92,49 @@ typedef struct seed_range {
 		};
 } seed_range_t;
 
-std::unique_ptr<std::vector<size_t>>
-parse_seeds(const std::string &line, const size_t offset = 0) {
+std::pmr::vector<size_t>
+parse_seeds(const std::string_view line, const size_t offset,
+            std::pmr::memory_resource *resource) {
 	// "seeds: 79 14 55 13"
 	// or
 	// "79 14 55 13"
 	// specified by offset
-	auto seeds = std::make_unique<std::vector<size_t>>();
+	std::pmr::vector<size_t> seeds(resource);
 
-	std::istringstream stream(line.substr(offset));
+	scan::scanner_t scanner(line.substr(offset));
 
-	size_t seed;
-	while (stream >> seed) {
-		seeds->push_back(seed);
+	uint64_t seed{};
+	while (scanner.next(seed)) {
+		seeds.push_back(seed);
 	}
 
 	return seeds;
 }
 
-std::unique_ptr<std::vector<input_map_rule_t>>
-parse_input_map_rules(const std::vector<std::string> &data, const size_t from,
-                      size_t *upto) {
+std::pmr::vector<input_map_rule_t>
+parse_input_map_rules(const std::vector<std::string_view> &data, const size_t from,
+                      size_t *upto, std::pmr::memory_resource *resource) {
 	// parse
 	//  seed-to-soil map:
 	//  50 98 2
 	//  ...
 	size_t index = from + 1;
-	auto rules = std::make_unique<std::vector<input_map_rule_t>>();
+	std::pmr::vector<input_map_rule_t> rules(resource);
 
-	std::string line;
+	std::string_view line;
 	do {
 		line = data.at(index);
-		auto seed_info = parse_seeds(line);
-
-		if (seed_info->size() != 3) {
-			std::cout << "fatal: expected exactly 3 seed numbers in map entry"
-			          << std::endl;
-			exit(EXIT_FAILURE);
+		// "<dest> <source> <range>"
+		scan::scanner_t scanner(line);
+		uint64_t dest{}, source{}, range{}, extra{};
+
+		// thrown rather than exiting so the runner's batches can report it and go on
+		if (!scanner.next(dest) || !scanner.next(source) || !scanner.next(range) ||
+		    scanner.next(extra)) {
+			throw std::runtime_error("expected exactly 3 seed numbers in map entry");
 		}
 
-		rules->push_back({.source = seed_info->at(1),
-		                  .dest = seed_info->at(0),
-		                  .range = seed_info->at(2)});
+		rules.push_back({.source = source, .dest = dest, .range = range});
 
 		index++;
 	} while (index < data.size() && data.at(index).size() > 0);
@@ -119,23 +144,30 @@ parse_input_map_rules(const std::vector<std::string> &data, const size_t from,
 	return rules;
 }
 
+// the seeds and rule tables are allocated from resource, moved (not copied) into the
+// maps so they stay there
 std::unique_ptr<input_almanac_maps_t>
-parse_input_almanac_maps(const std::vector<std::string> &data) {
+parse_input_almanac_maps(const std::vector<std::string_view> &data,
+                         std::pmr::memory_resource *resource =
+                             std::pmr::get_default_resource()) {
+	INSTRUMENT_PHASE("parse");
+	INSTRUMENT_COUNT("lines parsed", data.size());
+
 	// "seeds: 79 14 55 13"
-	auto seeds = parse_seeds(data.at(0), std::string("seeds: ").length());
+	auto seeds = parse_seeds(data.at(0), std::string("seeds: ").length(), resource);
 
 	// "seed-to-soil map:" starts on line index 2
 	// then (++offset) consume the empty line between blocks
 	size_t offset = 2;
-	auto maps = std::make_unique<input_almanac_maps_t>(
-	    input_almanac_maps_t{*seeds,
-	                         {*parse_input_map_rules(data, offset, &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)},
-	                         {*parse_input_map_rules(data, (++offset), &offset)}});
+	auto maps = std::make_unique<input_almanac_maps_t>(input_almanac_maps_t{
+	    std::move(seeds),
+	    {parse_input_map_rules(data, offset, &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)},
+	    {parse_input_map_rules(data, (++offset), &offset, resource)}});
 
 	return maps;
 }
@@ -144,26 +176,13 @@ size_t
 follow_map_route(const input_almanac_maps_t &almanac_maps, const size_t start_idx) {
 	auto idx = start_idx;
 
-	auto seed_to_soil_map = almanac_maps.seed_to_soil_map;
-	idx = seed_to_soil_map.map(idx);
-
-	auto soil_to_fertilizer_map = almanac_maps.soil_to_fertilizer_map;
-	idx = soil_to_fertilizer_map.map(idx);
-
-	auto fertilizer_to_water_map = almanac_maps.fertilizer_to_water_map;
-	idx = fertilizer_to_water_map.map(idx);
-
-	auto water_to_light_map = almanac_maps.water_to_light_map;
-	idx = water_to_light_map.map(idx);
-
-	auto light_to_temperature_map = almanac_maps.light_to_temperature_map;
-	idx = light_to_temperature_map.map(idx);
-
-	auto temperature_to_humidity_map = almanac_maps.temperature_to_humidity_map;
-	idx = temperature_to_humidity_map.map(idx);
-
-	auto humidity_to_location_map = almanac_maps.humidity_to_location_map;
-	idx = humidity_to_location_map.map(idx);
+	idx = almanac_maps.seed_to_soil_map.map(idx);
+	idx = almanac_maps.soil_to_fertilizer_map.map(idx);
+	idx = almanac_maps.fertilizer_to_water_map.map(idx);
+	idx = almanac_maps.water_to_light_map.map(idx);
+	idx = almanac_maps.light_to_temperature_map.map(idx);
+	idx = almanac_maps.temperature_to_humidity_map.map(idx);
+	idx = almanac_maps.humidity_to_location_map.map(idx);
 
 	return idx;
 }
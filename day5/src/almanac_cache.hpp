@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "../../common/cache.hpp"
+#include "almanac.hpp"
+
+namespace almanac_cache {
+
+// The seeds and each map's rule table as they are in memory, one cache section each:
+//   0  seeds
+//   1  seed-to-soil rules, ..., 7  humidity-to-location rules
+
+constexpr uint32_t DAY = 5;
+constexpr uint32_t VERSION = 1;   // bump when the sections above change
+
+bool
+save(const almanac::input_almanac_maps_t &maps, const uint64_t input_hash) {
+	cache::writer_t writer;
+	writer.add(std::span<const size_t>(maps.initial_seeds));
+	for (const auto *map : almanac::maps_of(maps)) {
+		writer.add(std::span<const almanac::input_map_rule_t>(map->rules));
+	}
+
+	return writer.write(DAY, VERSION, input_hash);
+}
+
+std::unique_ptr<almanac::input_almanac_maps_t>
+load(const cache::reader_t &reader, std::pmr::memory_resource *resource) {
+	INSTRUMENT_PHASE("cache (load)");
+
+	const auto seeds = reader.array<size_t>(0);
+	if (!seeds.has_value()) {
+		return nullptr;
+	}
+
+	std::array<std::span<const almanac::input_map_rule_t>, almanac::N_MAPS> tables;
+	for (size_t i = 0; i < almanac::N_MAPS; i++) {
+		const auto rules = reader.array<almanac::input_map_rule_t>(1 + i);
+		if (!rules.has_value()) {
+			return nullptr;
+		}
+		tables[i] = *rules;
+	}
+
+	auto map = [&](const size_t i) {
+		return almanac::input_map_t{std::pmr::vector<almanac::input_map_rule_t>(
+		    tables[i].begin(), tables[i].end(), resource)};
+	};
+
+	return std::make_unique<almanac::input_almanac_maps_t>(almanac::input_almanac_maps_t{
+	    std::pmr::vector<size_t>(seeds->begin(), seeds->end(), resource), map(0), map(1),
+	    map(2), map(3), map(4), map(5), map(6)});
+}
+
+// from the cache when AOC_CACHE is set and there is one for these contents, otherwise
+// parsed from data (the lines of contents) and, when AOC_CACHE is set, cached
+std::unique_ptr<almanac::input_almanac_maps_t>
+parse(const std::string_view contents, const std::vector<std::string_view> &data,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	if (!cache::enabled()) {
+		return almanac::parse_input_almanac_maps(data, resource);
+	}
+
+	const uint64_t input_hash = cache::hash(contents);
+
+	if (auto reader = cache::open(DAY, VERSION, input_hash)) {
+		if (auto maps = load(*reader, resource)) {
+			return maps;
+		}
+	}
+
+	auto maps = almanac::parse_input_almanac_maps(data, resource);
+	save(*maps, input_hash);
+
+	return maps;
+}
+
+}   // namespace almanac_cache
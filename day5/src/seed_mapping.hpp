@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+
+#include <immintrin.h>
+
+#include "../../common/dispatch.hpp"
+#include "../../common/pages.hpp"
+#include "almanac.hpp"
+
+namespace seed_mapping {
+
+// Part two maps every seed of a block through all seven maps and keeps the smallest
+// location. Here the maps are compiled into one flat table of source ranges and
+// offsets, and a block is mapped several consecutive seeds at a time, one per vector
+// lane: 2, 4 or 8 of them (SSE4.2, AVX2, AVX-512, picked at run time by
+// common/dispatch.hpp).
+//
+// A rule covers seed when seed - lo <= span (unsigned, so a seed below lo wraps round
+// to a large number and fails too), one compare per lane. A lane can't stop at its
+// first matching rule like input_map_t::map does, so every rule of a map is tested
+// against every lane in order and a later match overwrites an earlier one. The last
+// rule that matches wins, the same one map() finds searching from the end.
+
+typedef struct Table {
+		std::pmr::vector<uint64_t> lo;
+		std::pmr::vector<uint64_t> span;     // range - 1
+		std::pmr::vector<uint64_t> offset;   // dest - source, wrapping
+
+		// map m's rules are [starts[m], starts[m + 1])
+		std::array<size_t, almanac::N_MAPS + 1> starts;
+
+		explicit Table(std::pmr::memory_resource *resource = pages::resource())
+		    : lo(resource), span(resource), offset(resource), starts{} {
+		}
+} table_t;
+
+table_t
+compile(const almanac::input_almanac_maps_t &maps) {
+	table_t table;
+
+	size_t m = 0;
+	for (const auto *map : almanac::maps_of(maps)) {
+		table.starts[m++] = table.lo.size();
+
+		for (auto rule = map->rules.begin(); rule != map->rules.end(); rule++) {
+			// covers nothing, except from 0 where map() has it cover everything
+			if (rule->range == 0 && rule->source != 0) {
+				continue;
+			}
+
+			table.lo.push_back(rule->source);
+			table.span.push_back(rule->range - 1);
+			table.offset.push_back(rule->dest - rule->source);
+		}
+	}
+	table.starts[m] = table.lo.size();
+
+	return table;
+}
+
+inline uint64_t
+location_of(const table_t &table, uint64_t seed) {
+	for (size_t m = 0; m < almanac::N_MAPS; m++) {
+		for (size_t r = table.starts[m + 1]; r-- > table.starts[m];) {
+			if (seed - table.lo[r] <= table.span[r]) {
+				seed += table.offset[r];
+				break;
+			}
+		}
+	}
+	return seed;
+}
+
+// smallest location of the seeds [first, last)
+inline uint64_t
+min_location_scalar(const table_t &table, const uint64_t first, const uint64_t last) {
+	uint64_t smallest = UINT64_MAX;
+	for (uint64_t seed = first; seed < last; seed++) {
+		smallest = std::min(smallest, location_of(table, seed));
+	}
+	return smallest;
+}
+
+// SSE4.2 and AVX2 have only signed 64 bit compares, flipping the top bit of both sides
+// makes a signed compare give the unsigned answer
+TARGET_SSE42 inline uint64_t
+min_location_sse42(const table_t &table, const uint64_t first, const uint64_t last) {
+	const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+	const __m128i lane = _mm_set_epi64x(1, 0);
+
+	__m128i smallest = _mm_set1_epi64x(-1);
+	uint64_t seed = first;
+
+	for (; seed < last && last - seed >= 2; seed += 2) {
+		__m128i x = _mm_add_epi64(_mm_set1_epi64x((int64_t) seed), lane);
+
+		for (size_t m = 0; m < almanac::N_MAPS; m++) {
+			__m128i y = x;
+
+			for (size_t r = table.starts[m]; r < table.starts[m + 1]; r++) {
+				const __m128i from_lo =
+				    _mm_sub_epi64(x, _mm_set1_epi64x((int64_t) table.lo[r]));
+				const __m128i span =
+				    _mm_set1_epi64x((int64_t) (table.span[r] ^ INT64_MIN));
+				const __m128i outside =
+				    _mm_cmpgt_epi64(_mm_xor_si128(from_lo, sign), span);
+				const __m128i mapped =
+				    _mm_add_epi64(x, _mm_set1_epi64x((int64_t) table.offset[r]));
+				y = _mm_blendv_epi8(mapped, y, outside);
+			}
+
+			x = y;
+		}
+
+		const __m128i is_smaller =
+		    _mm_cmpgt_epi64(_mm_xor_si128(smallest, sign), _mm_xor_si128(x, sign));
+		smallest = _mm_blendv_epi8(smallest, x, is_smaller);
+	}
+
+	alignas(16) uint64_t lanes[2];
+	_mm_store_si128((__m128i *) lanes, smallest);
+
+	return std::min({min_location_scalar(table, seed, last), lanes[0], lanes[1]});
+}
+
+TARGET_AVX2 inline uint64_t
+min_location_avx2(const table_t &table, const uint64_t first, const uint64_t last) {
+	const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+	const __m256i lane = _mm256_set_epi64x(3, 2, 1, 0);
+
+	__m256i smallest = _mm256_set1_epi64x(-1);
+	uint64_t seed = first;
+
+	for (; seed < last && last - seed >= 4; seed += 4) {
+		__m256i x = _mm256_add_epi64(_mm256_set1_epi64x((int64_t) seed), lane);
+
+		for (size_t m = 0; m < almanac::N_MAPS; m++) {
+			__m256i y = x;
+
+			for (size_t r = table.starts[m]; r < table.starts[m + 1]; r++) {
+				const __m256i from_lo =
+				    _mm256_sub_epi64(x, _mm256_set1_epi64x((int64_t) table.lo[r]));
+				const __m256i span =
+				    _mm256_set1_epi64x((int64_t) (table.span[r] ^ INT64_MIN));
+				const __m256i outside =
+				    _mm256_cmpgt_epi64(_mm256_xor_si256(from_lo, sign), span);
+				const __m256i mapped =
+				    _mm256_add_epi64(x, _mm256_set1_epi64x((int64_t) table.offset[r]));
+				y = _mm256_blendv_epi8(mapped, y, outside);
+			}
+
+			x = y;
+		}
+
+		const __m256i is_smaller = _mm256_cmpgt_epi64(_mm256_xor_si256(smallest, sign),
+		                                              _mm256_xor_si256(x, sign));
+		smallest = _mm256_blendv_epi8(smallest, x, is_smaller);
+	}
+
+	alignas(32) uint64_t lanes[4];
+	_mm256_store_si256((__m256i *) lanes, smallest);
+
+	return std::min({min_location_scalar(table, seed, last), lanes[0], lanes[1],
+	                 lanes[2], lanes[3]});
+}
+
+// unsigned compares and masked adds, so no sign flipping or blending
+TARGET_AVX512 inline uint64_t
+min_location_avx512(const table_t &table, const uint64_t first, const uint64_t last) {
+	const __m512i lane = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+
+	__m512i smallest = _mm512_set1_epi64(-1);
+	uint64_t seed = first;
+
+	for (; seed < last && last - seed >= 8; seed += 8) {
+		__m512i x = _mm512_add_epi64(_mm512_set1_epi64((int64_t) seed), lane);
+
+		for (size_t m = 0; m < almanac::N_MAPS; m++) {
+			__m512i y = x;
+
+			for (size_t r = table.starts[m]; r < table.starts[m + 1]; r++) {
+				const __m512i from_lo =
+				    _mm512_sub_epi64(x, _mm512_set1_epi64((int64_t) table.lo[r]));
+				const __mmask8 in = _mm512_cmple_epu64_mask(
+				    from_lo, _mm512_set1_epi64((int64_t) table.span[r]));
+				y = _mm512_mask_add_epi64(y, in, x,
+				                          _mm512_set1_epi64((int64_t) table.offset[r]));
+			}
+
+			x = y;
+		}
+
+		// the masked form, the plain one trips a false uninitialised warning in GCC 12
+		smallest = _mm512_mask_min_epu64(smallest, 0xFF, smallest, x);
+	}
+
+	alignas(64) uint64_t lanes[8];
+	_mm512_store_si512(lanes, smallest);
+
+	return std::min({min_location_scalar(table, seed, last), lanes[0], lanes[1],
+	                 lanes[2], lanes[3], lanes[4], lanes[5], lanes[6], lanes[7]});
+}
+
+typedef uint64_t (*kernel_t)(const table_t &table, const uint64_t first,
+                             const uint64_t last);
+
+// the best variant for this machine, look it up once outside a loop
+inline kernel_t
+kernel() {
+	static const kernel_t chosen =
+	    dispatch::select<kernel_t>(min_location_scalar, min_location_sse42,
+	                               min_location_avx2, min_location_avx512);
+	return chosen;
+}
+
+}   // namespace seed_mapping
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "../../common/instrument.hpp"
+#include "../../common/pool.hpp"
+#include "almanac.hpp"
+#include "seed_mapping.hpp"
+
+namespace almanac {
+
+size_t
+min_location_number(const input_almanac_maps_t &almanac_maps) {
+	INSTRUMENT_PHASE("solve (part one)");
+	INSTRUMENT_COUNT("seeds mapped", almanac_maps.initial_seeds.size());
+
+	std::vector<size_t> end_points{};
+
+	for (auto start_point : almanac_maps.initial_seeds) {
+		end_points.push_back(follow_map_route(almanac_maps, start_point));
+	}
+
+	return *std::min_element(end_points.begin(), end_points.end());
+}
+
+std::unique_ptr<std::vector<seed_range_t>>
+split_seed_ranges(const input_almanac_maps_t &almanac_maps) {
+	// for part 2, initial seeds come in pairs of <start> and <range>
+	// break these down into somewhat similar sized chunks for parallelising
+	// 10m and 20m blocks seem to be about the same speed
+	auto seed_ranges = std::make_unique<std::vector<seed_range_t>>();
+	for (size_t i = 0; i < almanac_maps.initial_seeds.size();) {
+		auto start = almanac_maps.initial_seeds.at(i++);
+		auto range = almanac_maps.initial_seeds.at(i++);
+
+		size_t block_size = 40000000;
+
+		while (range > 0) {
+			if (range > block_size) {
+				seed_ranges->push_back({start, block_size});
+				start += block_size + 1;
+				range -= block_size;
+			} else {
+				seed_ranges->push_back({start, range});
+				range = 0;
+			}
+		}
+	}
+
+	return seed_ranges;
+}
+
+size_t
+min_location_number_for_seed_range(const input_almanac_maps_t &almanac_maps,
+                                   const std::vector<seed_range_t> &seed_ranges) {
+	INSTRUMENT_PHASE("solve (part two)");
+
+	std::vector<size_t> block_smallest(seed_ranges.size(), UINT64_MAX);
+
+	// by pointer, the tasks would otherwise each get a private copy of the vector
+	size_t *out = block_smallest.data();
+
+	const auto table = seed_mapping::compile(almanac_maps);
+	const auto min_location = seed_mapping::kernel();
+
+	pool::run([&]() {
+#pragma omp taskloop grainsize(1) firstprivate(out)
+		for (size_t b = 0; b < seed_ranges.size(); b++) {
+			// timed per block as well so hardware counters see every worker thread
+			INSTRUMENT_PHASE("solve (part two, per block)");
+
+			auto seeds = seed_ranges[b];
+			INSTRUMENT_COUNT("seeds mapped", seeds.end() - seeds.start);
+			INSTRUMENT_NO_ALLOCATIONS("seed mapping");
+
+			out[b] = min_location(table, seeds.start, seeds.end());
+		}
+	});
+
+	// TODO TRY SPEED OF:
+	// humidity-to-location map
+	// this means that humidity has ranges
+	//   0..55  =>   0..55
+	//  56..92  =>  60..96
+	//  93..96  =>  56..59
+	// temperature-to-humidity map
+	//  69..70  =>   0..1   =>   0..1 (in endpoints)
+	//  ...
+
+	size_t smallest = UINT64_MAX;
+	for (auto s : block_smallest) {
+		smallest = std::min(smallest, s);
+	}
+
+	return smallest;
+}
+
+}   // namespace almanac
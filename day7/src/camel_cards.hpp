@@ -1,19 +1,25 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <iostream>
+#include <memory_resource>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "../../common/instrument.hpp"
+
 namespace camel_cards {
 
 const std::vector<char> simple_card_ordering{'2', '3', '4', '5', '6', '7', '8',
                                              '9', 'T', 'J', 'Q', 'K', 'A'};
 const std::vector<char> complex_card_ordering{'J', '2', '3', '4', '5', '6', '7',
                                               '8', '9', 'T', 'Q', 'K', 'A'};
+constexpr size_t n_cards = 13;
 
 const std::unordered_map<int, std::string> _dbg_score_to_name = {
     {7, "five of a kind"},  {6, "four of a kind"}, {5, "full house"},
@@ -28,6 +34,8 @@ typedef struct Hand {
 	u_int64_t score_complex;
 } hand_t;
 
+typedef std::pmr::vector<hand_t> hands_t;
+
 inline std::optional<u_int64_t>
 simple_value(const char card) {
 
@@ -41,7 +49,7 @@ simple_value(const char card) {
 
 inline std::optional<u_int64_t>
 simple_strength(const std::string &cards) {
-	std::vector<size_t> card_counts(simple_card_ordering.size(), 0);
+	std::array<size_t, n_cards> card_counts{};
 
 	for (auto c : cards) {
 		auto v = simple_value(c);
@@ -92,15 +100,18 @@ simple_strength(const std::string &cards) {
 	return 1;   // high-card
 }
 
+// with the strength already known, e.g. from hand_type
 inline u_int64_t
-simple_score(const std::string &cards) {
+simple_score(const std::string &cards, const u_int64_t strength) {
+	INSTRUMENT_COUNT("hands scored", 1);
+
 	u_int64_t combined_score = 0;
 
 	// strength       <= 7      => 3 bits
 	// each tie break <= 12     => 4 bits (4 x 5 = 20 bits)
 	// .: we can store the entire score in 23 bits
 	// I shall do each as 4 bits as it is neater
-	combined_score += simple_strength(cards).value();
+	combined_score += strength;
 	combined_score = combined_score << 4;
 
 	for (auto card : cards) {
@@ -111,6 +122,11 @@ simple_score(const std::string &cards) {
 	return combined_score;
 }
 
+inline u_int64_t
+simple_score(const std::string &cards) {
+	return simple_score(cards, simple_strength(cards).value());
+}
+
 inline std::optional<u_int64_t>
 complex_value(const char card) {
 
@@ -126,7 +142,7 @@ inline std::optional<u_int64_t>
 complex_strength(const std::string &cards) {
 	// handle jokers separately
 	u_int64_t n_jokers = 0;
-	std::vector<size_t> card_counts(complex_card_ordering.size(), 0);
+	std::array<size_t, n_cards> card_counts{};
 
 	for (auto c : cards) {
 		if (c == 'J') {
@@ -212,12 +228,15 @@ complex_strength(const std::string &cards) {
 	return 1;   // high-card
 }
 
+// with the strength already known, e.g. from hand_type
 inline u_int64_t
-complex_score(const std::string &cards) {
+complex_score(const std::string &cards, const u_int64_t strength) {
+	INSTRUMENT_COUNT("hands scored", 1);
+
 	u_int64_t combined_score = 0;
 
 	// see simple_score
-	combined_score += complex_strength(cards).value();
+	combined_score += strength;
 	combined_score = combined_score << 4;
 
 	for (auto card : cards) {
@@ -228,35 +247,41 @@ complex_score(const std::string &cards) {
 	return combined_score;
 }
 
-u_int64_t
-calc_total_winnings_simple(std::vector<camel_cards::hand_t> &hands) {
-	std::vector<camel_cards::hand_t> hands_(hands);
+inline u_int64_t
+complex_score(const std::string &cards) {
+	return complex_score(cards, complex_strength(cards).value());
+}
+
+// sums each bid times the rank of its hand by score. Only an index array is sorted,
+// from the hands' own memory resource, so the hands and their strings never move.
+inline u_int64_t
+total_winnings(const hands_t &hands, u_int64_t hand_t::*score) {
+	std::pmr::vector<uint32_t> order(hands.size(), hands.get_allocator());
+	std::iota(order.begin(), order.end(), 0);
 
-	std::sort(hands_.begin(), hands_.end(),
-	          [](auto lhs, auto rhs) { return lhs.score_simple < rhs.score_simple; });
+	std::sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+		return hands[lhs].*score < hands[rhs].*score;
+	});
 
+	INSTRUMENT_NO_ALLOCATIONS("ranking");
 	u_int64_t total = 0;
 
-	for (size_t i = 0; i < hands_.size(); i++) {
-		total += (i + 1) * hands_.at(i).bid;
+	for (size_t i = 0; i < order.size(); i++) {
+		total += (i + 1) * hands[order[i]].bid;
 	}
 
 	return total;
 }
 
 u_int64_t
-calc_total_winnings_complex(std::vector<camel_cards::hand_t> &hands) {
-	std::vector<camel_cards::hand_t> hands_(hands);
-
-	std::sort(hands_.begin(), hands_.end(),
-	          [](auto lhs, auto rhs) { return lhs.score_complex < rhs.score_complex; });
-
-	u_int64_t total = 0;
-
-	for (size_t i = 0; i < hands_.size(); i++) {
-		total += (i + 1) * hands_.at(i).bid;
-	}
+calc_total_winnings_simple(const hands_t &hands) {
+	INSTRUMENT_PHASE("solve (part one)");
+	return total_winnings(hands, &hand_t::score_simple);
+}
 
-	return total;
+u_int64_t
+calc_total_winnings_complex(const hands_t &hands) {
+	INSTRUMENT_PHASE("solve (part two)");
+	return total_winnings(hands, &hand_t::score_complex);
 }
 }   // namespace camel_cards
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../../common/input.hpp"
+#include "../../common/instrument.hpp"
+#include "parser.hpp"
+
+namespace external {
+
+// Total winnings for hand files too large to hold in memory. Only a (score, bid) pair
+// per hand and rule set is kept, in buffers of bounded size: each time one fills it is
+// sorted and written out as a run to a temporary file. The runs of a rule set are then
+// k-way merged, walking the hands in rank order so the winnings are summed without
+// ever holding them all. If there are too many runs to merge at once they are first
+// merged in groups into longer runs.
+//
+// Nothing is written when everything fits in one buffer.
+
+typedef struct Config {
+		size_t memory_budget = (size_t) 64 << 20;   // bytes, for all buffers together
+		size_t max_fan_in = 256;                     // runs merged (files open) at once
+} config_t;
+
+typedef struct Results {
+		uint64_t part_one;
+		uint64_t part_two;
+		size_t n_hands;
+		size_t n_runs;   // written for both rule sets, before any intermediate merges
+} results_t;
+
+typedef struct Entry {
+		uint64_t score;
+		uint64_t bid;
+
+		inline bool operator<(const Entry &other) const {
+			return score < other.score || (score == other.score && bid < other.bid);
+		}
+
+		inline bool operator>(const Entry &other) const {
+			return other < *this;
+		}
+} entry_t;
+
+// an unlinked temporary file, gone when it is closed
+typedef struct RunFile {
+		FILE *file = nullptr;
+		size_t n_entries = 0;
+
+		RunFile() = default;
+		RunFile(const RunFile &) = delete;
+		RunFile &operator=(const RunFile &) = delete;
+
+		RunFile(RunFile &&other) noexcept
+		    : file(std::exchange(other.file, nullptr)),
+		      n_entries(std::exchange(other.n_entries, 0)) {
+		}
+
+		RunFile &operator=(RunFile &&other) noexcept {
+			std::swap(file, other.file);
+			std::swap(n_entries, other.n_entries);
+			return *this;
+		}
+
+		~RunFile() {
+			if (file != nullptr) {
+				fclose(file);
+			}
+		}
+
+		void write(const entry_t *entries, const size_t n) {
+			if (fwrite(entries, sizeof(entry_t), n, file) != n) {
+				std::cout << "fatal: can't write run file" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			n_entries += n;
+		}
+} run_file_t;
+
+// in TMPDIR if set, otherwise /tmp
+run_file_t
+create_run_file() {
+	auto path =
+	    (std::filesystem::temp_directory_path() / "aoc-day7-run-XXXXXX").string();
+
+	const int fd = mkstemp(path.data());
+	if (fd < 0) {
+		std::cout << "fatal: can't create run file in " << path << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	unlink(path.c_str());
+
+	run_file_t run;
+	run.file = fdopen(fd, "w+b");
+	if (run.file == nullptr) {
+		close(fd);
+		std::cout << "fatal: can't open run file in " << path << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	INSTRUMENT_COUNT("runs written", 1);
+
+	return run;
+}
+
+// collects the entries of one rule set, spilling sorted runs when the buffer fills
+typedef struct RunWriter {
+		std::vector<entry_t> buffer;
+		std::vector<run_file_t> runs;
+		size_t n_spilled = 0;
+
+		explicit RunWriter(const size_t capacity) {
+			buffer.reserve(std::max(capacity, (size_t) 1));
+		}
+
+		void push(const entry_t entry) {
+			buffer.push_back(entry);
+			if (buffer.size() == buffer.capacity()) {
+				spill();
+			}
+		}
+
+		void spill() {
+			if (buffer.empty()) {
+				return;
+			}
+
+			std::sort(buffer.begin(), buffer.end());
+
+			auto run = create_run_file();
+			run.write(buffer.data(), buffer.size());
+			runs.push_back(std::move(run));
+			n_spilled++;
+
+			buffer.clear();
+		}
+
+		// spill what is left and free the buffer, leaving only runs
+		void finish() {
+			spill();
+			buffer = {};
+		}
+} run_writer_t;
+
+// reads a run back from the start, a buffer at a time
+typedef struct RunReader {
+		run_file_t *run;
+		std::vector<entry_t> buffer;
+		size_t position = 0;
+
+		RunReader(run_file_t &run, const size_t capacity)
+		    : run(&run), buffer(std::max(capacity, (size_t) 1)) {
+			rewind(run.file);
+			buffer.resize(0);
+		}
+
+		// false once the run is exhausted
+		bool refill() {
+			buffer.resize(buffer.capacity());
+			const size_t n =
+			    fread(buffer.data(), sizeof(entry_t), buffer.size(), run->file);
+			buffer.resize(n);
+			position = 0;
+			return n > 0;
+		}
+
+		bool has_next() {
+			return position < buffer.size() || refill();
+		}
+
+		entry_t next() {
+			return buffer[position++];
+		}
+} run_reader_t;
+
+// visits every entry of the runs in sorted order, using at most budget bytes of buffers
+template <typename F>
+void
+merge(std::vector<run_file_t> &runs, const size_t budget, F &&visit) {
+	const size_t per_run = budget / sizeof(entry_t) / std::max(runs.size(), (size_t) 1);
+
+	std::vector<run_reader_t> readers;
+	readers.reserve(runs.size());
+	for (auto &run : runs) {
+		readers.emplace_back(run, per_run);
+	}
+
+	typedef std::pair<entry_t, size_t> head_t;   // smallest unvisited entry of a run
+	std::priority_queue<head_t, std::vector<head_t>, std::greater<head_t>> heads;
+
+	for (size_t i = 0; i < readers.size(); i++) {
+		if (readers[i].has_next()) {
+			heads.push({readers[i].next(), i});
+		}
+	}
+
+	while (!heads.empty()) {
+		const auto [entry, i] = heads.top();
+		heads.pop();
+
+		visit(entry);
+
+		if (readers[i].has_next()) {
+			heads.push({readers[i].next(), i});
+		}
+	}
+}
+
+// merge groups of runs into longer runs until at most max_fan_in are left
+void
+reduce_runs(std::vector<run_file_t> &runs, const config_t &config) {
+	const size_t fan_in = std::max(config.max_fan_in, (size_t) 2);
+
+	while (runs.size() > fan_in) {
+		std::vector<run_file_t> merged;
+
+		for (size_t first = 0; first < runs.size(); first += fan_in) {
+			const size_t last = std::min(runs.size(), first + fan_in);
+			std::vector<run_file_t> group(std::make_move_iterator(runs.begin() + first),
+			                              std::make_move_iterator(runs.begin() + last));
+
+			auto out = create_run_file();
+			merge(group, config.memory_budget,
+			      [&](const entry_t e) { out.write(&e, 1); });
+			merged.push_back(std::move(out));
+		}
+
+		runs = std::move(merged);
+	}
+}
+
+// sum of rank × bid over the entries of one rule set, either all still in the buffer
+// or all in runs
+uint64_t
+total_winnings(run_writer_t &writer, const config_t &config) {
+	uint64_t total = 0;
+	uint64_t rank = 1;
+
+	if (writer.runs.empty()) {
+		std::sort(writer.buffer.begin(), writer.buffer.end());
+		for (const auto &e : writer.buffer) {
+			total += rank++ * e.bid;
+		}
+		return total;
+	}
+
+	reduce_runs(writer.runs, config);
+	merge(writer.runs, config.memory_budget,
+	      [&](const entry_t e) { total += rank++ * e.bid; });
+
+	return total;
+}
+
+results_t
+solve(const input::lines_t &lines, const config_t &config = {}) {
+	INSTRUMENT_PHASE("solve (external)");
+
+	// half the budget for each rule set while the runs are being written
+	const size_t capacity = config.memory_budget / 2 / sizeof(entry_t);
+	run_writer_t simple(capacity);
+	run_writer_t complex(capacity);
+
+	size_t n_hands = 0;
+	for (auto line : lines) {
+		if (line.empty()) {
+			continue;
+		}
+
+		const auto hand = parser::parse_hand(line);
+		simple.push({hand.score_simple, hand.bid});
+		complex.push({hand.score_complex, hand.bid});
+		n_hands++;
+	}
+	INSTRUMENT_COUNT("lines parsed", n_hands);
+
+	// both fill at the same rate, so either both have spilled or neither has. If they
+	// have, spill the rest too so each merge gets the whole budget.
+	if (!simple.runs.empty()) {
+		simple.finish();
+		complex.finish();
+	}
+
+	const uint64_t part_one = total_winnings(simple, config);
+	const size_t n_runs = simple.n_spilled + complex.n_spilled;
+	simple = run_writer_t(0);   // closes its runs before the next merge
+
+	const uint64_t part_two = total_winnings(complex, config);
+
+	return {part_one, part_two, n_hands, n_runs};
+}
+
+// "64M", "512K", "2G" or a plain number of bytes, 0 if it isn't any of those
+size_t
+parse_size(const std::string &s) {
+	size_t n = 0;
+	size_t i = 0;
+	while (i < s.size() && '0' <= s[i] && s[i] <= '9') {
+		n = n * 10 + (size_t) (s[i++] - '0');
+	}
+
+	if (i + 1 < s.size() || i == 0) {
+		return 0;
+	}
+	if (i == s.size()) {
+		return n;
+	}
+
+	switch (s[i]) {
+	case 'K':
+	case 'k':
+		return n << 10;
+	case 'M':
+	case 'm':
+		return n << 20;
+	case 'G':
+	case 'g':
+		return n << 30;
+	default:
+		return 0;
+	}
+}
+
+}   // namespace external
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <immintrin.h>
+
+#include "../../common/dispatch.hpp"
+
+namespace hand_type {
+
+// The type (strength 1 to 7, see camel_cards) of many five card hands at once. Each
+// hand is packed into the low five bytes of a 64 bit word, one hand per vector lane: 2,
+// 4 or 8 of them (SSE4.2, AVX2, AVX-512, picked at run time by common/dispatch.hpp).
+//
+// Comparing a hand with itself rotated by 1 to 4 cards counts its ordered pairs of
+// matching cards, sum c * (c - 1) over the count c of each card, which is 0, 2, 4, 6,
+// 8, 12 or 20 from high card up to five of a kind. With jokers each J is first swapped
+// for a byte no other card can match, then the type comes from the pairs among the
+// rest and the number of jokers, looked up in key_to_strength.
+
+constexpr size_t N_CARDS = 5;
+constexpr uint64_t CARDS = 0xFF'FF'FF'FF'FF;         // the bytes holding cards
+constexpr uint64_t ONE_PER_CARD = 0x01'01'01'01'01;   // 1 in each of those
+constexpr uint64_t STAND_INS = 0x05'04'03'02'01;      // for jokers, unique per position
+
+// the cards of a hand of exactly five, in the low bytes
+inline uint64_t
+pack(const std::string &cards) {
+	uint64_t packed = 0;
+	std::memcpy(&packed, cards.data(), N_CARDS);
+	return packed;
+}
+
+// pairs of matching cards (at most 20) in the low five bits, jokers above
+constexpr uint8_t
+key(const uint64_t pairs, const uint64_t jokers) {
+	return (uint8_t) (pairs | (jokers << 5));
+}
+
+constexpr uint8_t
+strength_of_pairs(const uint64_t pairs) {
+	switch (pairs) {
+	case 20:
+		return 7;   // five of a kind
+	case 12:
+		return 6;   // four of a kind
+	case 8:
+		return 5;   // full house
+	case 6:
+		return 4;   // three of a kind
+	case 4:
+		return 3;   // two pair
+	case 2:
+		return 2;   // one pair
+	default:
+		return 1;   // high card
+	}
+}
+
+// the jokers all join the biggest group, of m cards, adding j * (j - 1) pairs among
+// themselves and 2 * m * j with it
+constexpr std::array<uint8_t, 256> key_to_strength = []() {
+	std::array<uint8_t, 256> table{};
+
+	for (uint64_t jokers = 0; jokers <= N_CARDS; jokers++) {
+		for (uint64_t pairs = 0; pairs <= 20; pairs++) {
+			const uint64_t biggest = pairs == 20                ? 5
+			                         : pairs == 12              ? 4
+			                         : pairs == 6 || pairs == 8 ? 3
+			                         : pairs == 2 || pairs == 4 ? 2
+			                         : jokers < N_CARDS         ? 1
+			                                                    : 0;
+
+			table[key(pairs, jokers)] =
+			    strength_of_pairs(pairs + jokers * (jokers - 1) + 2 * biggest * jokers);
+		}
+	}
+
+	return table;
+}();
+
+// the strengths of hands [0, n) into out, jokers wild if jokers is set
+inline void
+strengths_scalar(const uint64_t *hands, const size_t n, const bool jokers,
+                 uint8_t *out) {
+	for (size_t h = 0; h < n; h++) {
+		uint64_t hand = hands[h];
+		uint64_t n_jokers = 0;
+
+		if (jokers) {
+			for (size_t i = 0; i < N_CARDS; i++) {
+				if (((hand >> (8 * i)) & 0xFF) == 'J') {
+					hand = (hand & ~((uint64_t) 0xFF << (8 * i))) |
+					       ((STAND_INS >> (8 * i)) & 0xFF) << (8 * i);
+					n_jokers++;
+				}
+			}
+		}
+
+		uint64_t pairs = 0;
+		for (size_t i = 0; i < N_CARDS; i++) {
+			for (size_t j = 0; j < N_CARDS; j++) {
+				const uint64_t a = (hand >> (8 * i)) & 0xFF;
+				const uint64_t b = (hand >> (8 * j)) & 0xFF;
+				pairs += i != j && a == b;
+			}
+		}
+
+		out[h] = key_to_strength[key(pairs, n_jokers)];
+	}
+}
+
+// every lane's hand rotated by k cards, within its five bytes
+TARGET_SSE42 inline __m128i
+rotate_sse42(const __m128i hands, const int k) {
+	return _mm_and_si128(_mm_or_si128(_mm_srli_epi64(hands, 8 * k),
+	                                  _mm_slli_epi64(hands, 8 * (N_CARDS - k))),
+	                     _mm_set1_epi64x(CARDS));
+}
+
+TARGET_SSE42 inline void
+strengths_sse42(const uint64_t *hands, const size_t n, const bool jokers,
+                uint8_t *out) {
+	const __m128i one_per_card = _mm_set1_epi64x(ONE_PER_CARD);
+
+	size_t h = 0;
+	for (; n - h >= 2; h += 2) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (hands + h));
+		__m128i n_jokers = _mm_setzero_si128();
+
+		if (jokers) {
+			const __m128i is_joker = _mm_cmpeq_epi8(x, _mm_set1_epi8('J'));
+			x = _mm_blendv_epi8(x, _mm_set1_epi64x(STAND_INS), is_joker);
+			n_jokers = _mm_sad_epu8(_mm_and_si128(is_joker, one_per_card),
+			                        _mm_setzero_si128());
+		}
+
+		__m128i matches = _mm_setzero_si128();
+		for (int k = 1; k < (int) N_CARDS; k++) {
+			const __m128i same = _mm_cmpeq_epi8(x, rotate_sse42(x, k));
+			matches = _mm_add_epi8(matches, _mm_and_si128(same, one_per_card));
+		}
+		const __m128i pairs = _mm_sad_epu8(matches, _mm_setzero_si128());
+
+		alignas(16) uint64_t keys[2];
+		_mm_store_si128((__m128i *) keys,
+		                _mm_or_si128(pairs, _mm_slli_epi64(n_jokers, 5)));
+		out[h] = key_to_strength[keys[0]];
+		out[h + 1] = key_to_strength[keys[1]];
+	}
+
+	strengths_scalar(hands + h, n - h, jokers, out + h);
+}
+
+TARGET_AVX2 inline __m256i
+rotate_avx2(const __m256i hands, const int k) {
+	const __m256i right = _mm256_srli_epi64(hands, 8 * k);
+	const __m256i left = _mm256_slli_epi64(hands, 8 * (N_CARDS - k));
+	return _mm256_and_si256(_mm256_or_si256(right, left), _mm256_set1_epi64x(CARDS));
+}
+
+TARGET_AVX2 inline void
+strengths_avx2(const uint64_t *hands, const size_t n, const bool jokers, uint8_t *out) {
+	const __m256i one_per_card = _mm256_set1_epi64x(ONE_PER_CARD);
+
+	size_t h = 0;
+	for (; n - h >= 4; h += 4) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (hands + h));
+		__m256i n_jokers = _mm256_setzero_si256();
+
+		if (jokers) {
+			const __m256i is_joker = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('J'));
+			x = _mm256_blendv_epi8(x, _mm256_set1_epi64x(STAND_INS), is_joker);
+			n_jokers = _mm256_sad_epu8(_mm256_and_si256(is_joker, one_per_card),
+			                           _mm256_setzero_si256());
+		}
+
+		__m256i matches = _mm256_setzero_si256();
+		for (int k = 1; k < (int) N_CARDS; k++) {
+			const __m256i same = _mm256_cmpeq_epi8(x, rotate_avx2(x, k));
+			matches = _mm256_add_epi8(matches, _mm256_and_si256(same, one_per_card));
+		}
+		const __m256i pairs = _mm256_sad_epu8(matches, _mm256_setzero_si256());
+
+		alignas(32) uint64_t keys[4];
+		_mm256_store_si256((__m256i *) keys,
+		                   _mm256_or_si256(pairs, _mm256_slli_epi64(n_jokers, 5)));
+		for (size_t i = 0; i < 4; i++) {
+			out[h + i] = key_to_strength[keys[i]];
+		}
+	}
+
+	strengths_scalar(hands + h, n - h, jokers, out + h);
+}
+
+// compares straight into masks, so matches are counted with masked adds. The shifts
+// are the zero-masking forms only because the plain ones trip a false uninitialised
+// warning in GCC 12.
+TARGET_AVX512 inline void
+strengths_avx512(const uint64_t *hands, const size_t n, const bool jokers,
+                 uint8_t *out) {
+	const __m512i cards = _mm512_set1_epi64(CARDS);
+	const __m512i one = _mm512_set1_epi8(1);
+	const __m512i one_shifted = _mm512_set1_epi8(1 << 5);   // jokers go above the pairs
+	const __mmask64 in_hand = 0x1F1F'1F1F'1F1F'1F1F;        // five bytes of each eight
+
+	size_t h = 0;
+	for (; n - h >= 8; h += 8) {
+		__m512i x = _mm512_loadu_si512(hands + h);
+		__m512i n_jokers = _mm512_setzero_si512();
+
+		if (jokers) {
+			const __mmask64 is_joker = _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('J'));
+			x = _mm512_mask_blend_epi8(is_joker, x, _mm512_set1_epi64(STAND_INS));
+			n_jokers = _mm512_sad_epu8(_mm512_maskz_mov_epi8(is_joker, one_shifted),
+			                           _mm512_setzero_si512());
+		}
+
+		__m512i matches = _mm512_setzero_si512();
+		for (int k = 1; k < (int) N_CARDS; k++) {
+			const __m512i rotated = _mm512_and_si512(
+			    _mm512_or_si512(_mm512_maskz_srli_epi64(0xFF, x, 8 * k),
+			                    _mm512_maskz_slli_epi64(0xFF, x, 8 * (N_CARDS - k))),
+			    cards);
+			const __mmask64 same = _mm512_mask_cmpeq_epi8_mask(in_hand, x, rotated);
+			matches = _mm512_mask_add_epi8(matches, same, matches, one);
+		}
+		const __m512i pairs = _mm512_sad_epu8(matches, _mm512_setzero_si512());
+
+		alignas(64) uint64_t keys[8];
+		_mm512_store_si512(keys, _mm512_or_si512(pairs, n_jokers));
+		for (size_t i = 0; i < 8; i++) {
+			out[h + i] = key_to_strength[keys[i]];
+		}
+	}
+
+	strengths_scalar(hands + h, n - h, jokers, out + h);
+}
+
+typedef void (*kernel_t)(const uint64_t *hands, const size_t n, const bool jokers,
+                         uint8_t *out);
+
+// the best variant for this machine, look it up once outside a loop
+inline kernel_t
+kernel() {
+	static const kernel_t chosen = dispatch::select<kernel_t>(
+	    strengths_scalar, strengths_sse42, strengths_avx2, strengths_avx512);
+	return chosen;
+}
+
+}   // namespace hand_type
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/cache.hpp"
+#include "../../common/input.hpp"
+#include "camel_cards.hpp"
+#include "parser.hpp"
+
+namespace hands_cache {
+
+// The hands packed with both scores already worked out, in one cache section:
+//   0  packed_hand_t × n_hands
+
+constexpr uint32_t DAY = 7;
+constexpr uint32_t VERSION = 1;   // bump when the sections above change
+
+typedef struct PackedHand {
+		char cards[8];   // nul padded
+		uint64_t bid;
+		uint64_t score_simple;
+		uint64_t score_complex;
+} packed_hand_t;
+
+// not cached (false) if a hand has more cards than fit
+bool
+save(const camel_cards::hands_t &hands, const uint64_t input_hash) {
+	std::vector<packed_hand_t> packed;
+	packed.reserve(hands.size());
+
+	for (const auto &hand : hands) {
+		packed_hand_t p{};
+		if (hand.cards.size() > sizeof(p.cards)) {
+			return false;
+		}
+		std::memcpy(p.cards, hand.cards.data(), hand.cards.size());
+		p.bid = hand.bid;
+		p.score_simple = hand.score_simple;
+		p.score_complex = hand.score_complex;
+		packed.push_back(p);
+	}
+
+	cache::writer_t writer;
+	writer.add(std::span<const packed_hand_t>(packed));
+
+	return writer.write(DAY, VERSION, input_hash);
+}
+
+std::unique_ptr<camel_cards::hands_t>
+load(const cache::reader_t &reader, std::pmr::memory_resource *resource) {
+	INSTRUMENT_PHASE("cache (load)");
+
+	const auto packed = reader.array<packed_hand_t>(0);
+	if (!packed.has_value()) {
+		return nullptr;
+	}
+
+	auto hands = std::make_unique<camel_cards::hands_t>(resource);
+	hands->reserve(packed->size());
+
+	for (const auto &p : *packed) {
+		hands->push_back({std::string(p.cards, strnlen(p.cards, sizeof(p.cards))), p.bid,
+		                  p.score_simple, p.score_complex});
+	}
+
+	return hands;
+}
+
+// from the cache when AOC_CACHE is set and there is one for these contents, otherwise
+// parsed and, when AOC_CACHE is set, cached
+std::unique_ptr<camel_cards::hands_t>
+parse(const std::string_view contents,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	if (!cache::enabled()) {
+		return parser::parse_hands(input::lines_t{contents}, resource);
+	}
+
+	const uint64_t input_hash = cache::hash(contents);
+
+	if (auto reader = cache::open(DAY, VERSION, input_hash)) {
+		if (auto hands = load(*reader, resource)) {
+			return hands;
+		}
+	}
+
+	auto hands = parser::parse_hands(input::lines_t{contents}, resource);
+	save(*hands, input_hash);
+
+	return hands;
+}
+
+}   // namespace hands_cache
@@ -1,19 +1,59 @@
 #include <filesystem>
+#include <string>
 
+#include "../../common/arena.hpp"
+#include "../../common/input.hpp"
 #include "camel_cards.hpp"
-#include "parser.hpp"
+#include "external.hpp"
+#include "hands_cache.hpp"
 
+// [--external SIZE] [INPUT], with --external ranking through sorted runs on disk using
+// at most SIZE ("64M", "512K", ...) of buffers
 int
-main() {
-	const std::filesystem::path filepath{"day7/data/7.in"};
+main(int argc, char *argv[]) {
+	std::filesystem::path filepath{"day7/data/7.in"};
+	size_t memory_budget = 0;
 
-	if (!std::filesystem::exists(filepath)) {
+	for (int i = 1; i < argc; i++) {
+		const std::string arg{argv[i]};
+
+		if (arg == "--external") {
+			memory_budget = i + 1 < argc ? external::parse_size(argv[++i]) : 0;
+			if (memory_budget == 0) {
+				std::cout << "fatal: --external needs a size like 64M" << std::endl;
+				return EXIT_FAILURE;
+			}
+		} else {
+			filepath = arg;
+		}
+	}
+
+	auto file = input::map_file(filepath);
+
+	if (!file.has_value()) {
 		std::cout << "fatal: file not found" << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	auto data = parser::read_file(filepath);
-	auto hands = parser::parse_hands(*data);
+	if (memory_budget > 0) {
+		const auto results =
+		    external::solve(file->lines(), {.memory_budget = memory_budget});
+
+		std::cout << results.n_hands << " hands, " << results.n_runs << " runs written"
+		          << std::endl;
+		std::cout << std::endl;
+
+		std::cout << "result (part one): " << results.part_one << std::endl;
+		std::cout << std::endl;
+
+		std::cout << "result (part two): " << results.part_two << std::endl;
+		std::cout << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	arena::arena_t arena(file->contents().size() * 4);
+	auto hands = hands_cache::parse(file->contents(), arena.resource());
 
 	auto part_1_result = camel_cards::calc_total_winnings_simple(*hands);
 	std::cout << "result (part one): " << part_1_result << std::endl;
@@ -1,53 +1,91 @@
 #pragma once
 
-#include <fstream>
 #include <iostream>
 #include <memory>
-#include <sstream>
+#include <memory_resource>
+#include <string>
 #include <vector>
 
+#include "../../common/input.hpp"
+#include "../../common/instrument.hpp"
+#include "../../common/scan.hpp"
 #include "camel_cards.hpp"
+#include "hand_type.hpp"
 
 namespace parser {
 
-std::unique_ptr<std::vector<std::string>>
-read_file(const std::filesystem::path &filepath) {
-	auto lines = std::make_unique<std::vector<std::string>>();
+// cards and bid, not yet scored
+inline camel_cards::hand_t
+parse_unscored(const std::string_view line) {
+	// "32T3K 765"
+	const auto space = line.find(' ');
+	const std::string cards{line.substr(0, space)};
 
-	std::ifstream file(filepath);
-
-	if (!file.is_open()) {
-		std::cout << "fatal: can't open file" << std::endl;
-		exit(EXIT_FAILURE);
+	u_int64_t bid{};
+	if (space != std::string_view::npos) {
+		scan::scanner_t(line.substr(space)).next(bid);
 	}
 
-	std::string line;
-	while (getline(file, line)) {
-		lines->push_back(line);
-	}
+	return {cards, bid, 0, 0};
+}
 
-	return lines;
+inline camel_cards::hand_t
+parse_hand(const std::string_view line) {
+	auto hand = parse_unscored(line);
+	hand.score_simple = camel_cards::simple_score(hand.cards);
+	hand.score_complex = camel_cards::complex_score(hand.cards);
+	return hand;
 }
 
-std::unique_ptr<std::vector<camel_cards::hand_t>>
-parse_hands(const std::vector<std::string> &data) {
-	auto hands = std::make_unique<std::vector<camel_cards::hand_t>>();
+// the five card hands are typed together by hand_type's kernel, anything else one at a
+// time as before
+void
+score_hands(camel_cards::hands_t &hands) {
+	std::vector<uint64_t> packed;
+	std::vector<size_t> which;
+	packed.reserve(hands.size());
+	which.reserve(hands.size());
 
-	for (size_t i = 0; i < data.size(); i++) {
-		auto line = data.at(i);
-		std::stringstream ss(line);
+	for (size_t i = 0; i < hands.size(); i++) {
+		auto &hand = hands[i];
+		if (hand.cards.size() == hand_type::N_CARDS) {
+			packed.push_back(hand_type::pack(hand.cards));
+			which.push_back(i);
+		} else {
+			hand.score_simple = camel_cards::simple_score(hand.cards);
+			hand.score_complex = camel_cards::complex_score(hand.cards);
+		}
+	}
 
-		std::string cards{};
-		u_int64_t bid{};
+	const auto strengths = hand_type::kernel();
+	std::vector<uint8_t> simple(packed.size());
+	std::vector<uint8_t> complex(packed.size());
+	strengths(packed.data(), packed.size(), false, simple.data());
+	strengths(packed.data(), packed.size(), true, complex.data());
 
-		std::getline(ss, cards, ' ');
-		while (ss >> bid)
-			;
+	for (size_t j = 0; j < which.size(); j++) {
+		auto &hand = hands[which[j]];
+		hand.score_simple = camel_cards::simple_score(hand.cards, simple[j]);
+		hand.score_complex = camel_cards::complex_score(hand.cards, complex[j]);
+	}
+}
+
+// the hands are allocated from resource, the cards of each fit in std::string's small
+// buffer so need nothing more
+std::unique_ptr<camel_cards::hands_t>
+parse_hands(const input::lines_t &lines,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+	INSTRUMENT_PHASE("parse");
 
-		hands->push_back({cards, bid, camel_cards::simple_score(cards),
-		                  camel_cards::complex_score(cards)});
+	auto hands = std::make_unique<camel_cards::hands_t>(resource);
+
+	for (auto line : lines) {
+		INSTRUMENT_COUNT("lines parsed", 1);
+		hands->push_back(parse_unscored(line));
 	}
 
+	score_hands(*hands);
+
 	return hands;
 }
 
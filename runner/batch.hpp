@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/input.hpp"
+#include "days.hpp"
+#include "queue.hpp"
+
+namespace batch {
+
+// Solves one day over many inputs as a two stage pipeline: a reader thread maps and
+// parses the next inputs while the main thread solves the current one. The queue between
+// them is bounded, so however far ahead the reader gets at most `queue_size` + 2 inputs
+// (and their mapped files) are held at once: those queued, the one the reader is parsing
+// and the one being solved.
+//
+// An input which can't be read, parsed or solved is reported in its place and the rest
+// of the batch still runs.
+
+typedef struct Item {
+		std::filesystem::path filepath;
+		std::optional<input::mapped_file_t> file;
+		std::optional<days::parsed_t> parsed;   // declared after file, destroyed before it
+		double parse_ms;
+		std::string error;   // why there is nothing parsed
+} item_t;
+
+typedef struct Summary {
+		size_t n_files;
+		size_t n_failed;
+		size_t n_bytes;
+		double ms;
+} summary_t;
+
+inline double
+ms_since(const std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+	                                                 start)
+	    .count();
+}
+
+// every regular file in a directory, in name order, or each line of a manifest file as
+// a path
+std::optional<std::vector<std::filesystem::path>>
+list_inputs(const std::filesystem::path &source) {
+	std::vector<std::filesystem::path> inputs;
+
+	if (std::filesystem::is_directory(source)) {
+		for (const auto &entry : std::filesystem::directory_iterator(source)) {
+			if (entry.is_regular_file()) {
+				inputs.push_back(entry.path());
+			}
+		}
+		std::sort(inputs.begin(), inputs.end());
+		return inputs;
+	}
+
+	auto manifest = input::map_file(source);
+	if (!manifest.has_value()) {
+		return std::nullopt;
+	}
+
+	for (auto line : manifest->lines()) {
+		if (!line.empty()) {
+			inputs.emplace_back(line);
+		}
+	}
+	return inputs;
+}
+
+summary_t
+run(const days::day_t &day, const std::vector<std::filesystem::path> &inputs,
+    const size_t queue_size) {
+	summary_t summary{0, 0, 0, 0};
+	queue::bounded_queue_t<item_t> queue(std::max((size_t) 1, queue_size));
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::thread reader([&]() {
+		for (const auto &filepath : inputs) {
+			item_t item{filepath, input::map_file(filepath), std::nullopt, 0, {}};
+
+			if (!item.file.has_value()) {
+				item.error = "file not found";
+			} else {
+				try {
+					const auto parse_start = std::chrono::steady_clock::now();
+					item.parsed = day.parse(item.file->contents());
+					item.parse_ms = ms_since(parse_start);
+				} catch (const std::exception &e) {
+					item.error = e.what();
+				}
+			}
+
+			queue.push(std::move(item));
+		}
+		queue.close();
+	});
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	while (auto item = queue.pop()) {
+		summary.n_files++;
+
+		if (!item->parsed.has_value()) {
+			summary.n_failed++;
+			std::cout << item->filepath.string() << "  error: " << item->error << std::endl;
+			continue;
+		}
+
+		days::answers_t answers;
+		const auto solve_start = std::chrono::steady_clock::now();
+		try {
+			answers = (*item->parsed)();
+		} catch (const std::exception &e) {
+			summary.n_failed++;
+			std::cout << item->filepath.string() << "  error: " << e.what() << std::endl;
+			continue;
+		}
+		const double solve_ms = ms_since(solve_start);
+
+		summary.n_bytes += item->file->contents().size();
+
+		std::cout << item->filepath.string() << "  part one: " << answers.part_one
+		          << "  part two: " << answers.part_two << "  (parse " << item->parse_ms
+		          << "ms, solve " << solve_ms << "ms)" << std::endl;
+	}
+
+	reader.join();
+	summary.ms = ms_since(start);
+
+	return summary;
+}
+
+void
+print(const summary_t &summary) {
+	const double seconds = summary.ms / 1e3;
+
+	std::cout << std::endl
+	          << std::fixed << std::setprecision(3) << summary.n_files << " files ("
+	          << summary.n_failed << " failed), " << (double) summary.n_bytes / 1e6
+	          << " MB in " << summary.ms << "ms: " << std::setprecision(1)
+	          << (double) summary.n_files / seconds << " files/s, "
+	          << (double) summary.n_bytes / 1e6 / seconds << " MB/s" << std::endl;
+}
+
+}   // namespace batch
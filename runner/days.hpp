@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/arena.hpp"
+#include "../common/input.hpp"
+#include "../day1/src/calibration.hpp"
+#include "../day3/src/label_grid.hpp"
+#include "../day3/src/schematic.hpp"
+#include "../day3/src/schematic_cache.hpp"
+#include "../day5/src/almanac.hpp"
+#include "../day5/src/almanac_cache.hpp"
+#include "../day5/src/solve.hpp"
+#include "../day7/src/camel_cards.hpp"
+#include "../day7/src/hands_cache.hpp"
+#include "../day7/src/parser.hpp"
+
+namespace days {
+
+// Every C++ day behind one interface: the puzzle input in, both answers out. Each uses
+// its fastest solver, and may run its own parallel loops on the shared pool.
+
+typedef struct Answers {
+		uint64_t part_one;
+		uint64_t part_two;
+} answers_t;
+
+// what's left to do after parsing, may refer to the input contents so they must outlive
+// it, split out so that batches can parse one input while solving another
+typedef std::move_only_function<answers_t()> parsed_t;
+
+typedef struct Day {
+		std::string name;
+		std::string filepath;   // default input
+		parsed_t (*parse)(std::string_view contents);
+
+		answers_t solve(const std::string_view contents) const {
+			return parse(contents)();
+		}
+} day_t;
+
+// parsed state together with the arena (AOC_ARENA) it was allocated from, which is
+// declared first so it is destroyed last
+template <typename T>
+struct in_arena_t {
+		std::unique_ptr<arena::arena_t> arena;
+		T parsed;
+};
+
+parsed_t
+parse_day1(const std::string_view contents) {
+	// nothing to parse, the lines are read as they are solved
+	return [contents]() -> answers_t {
+		const input::lines_t lines{contents};
+		return {calibration::numeric::sum_calibration_values(lines),
+		        calibration::spelled::sum_calibration_values(lines)};
+	};
+}
+
+parsed_t
+parse_day3(const std::string_view contents) {
+	auto arena = std::make_unique<arena::arena_t>(contents.size());
+	auto schematic = schematic_cache::parse(contents, arena->resource());
+	return [state = in_arena_t{std::move(arena), std::move(schematic)}]() -> answers_t {
+		const auto results = label_grid::solve(*state.parsed);
+		return {results.part_sum, results.gear_ratio_sum};
+	};
+}
+
+parsed_t
+parse_day5(const std::string_view contents) {
+	auto arena = std::make_unique<arena::arena_t>(contents.size());
+	auto maps = almanac_cache::parse(contents, input::collect(input::lines_t{contents}),
+	                                 arena->resource());
+	return [state = in_arena_t{std::move(arena), std::move(maps)}]() -> answers_t {
+		const auto &maps = *state.parsed;
+		const auto seed_ranges = almanac::split_seed_ranges(maps);
+		return {almanac::min_location_number(maps),
+		        almanac::min_location_number_for_seed_range(maps, *seed_ranges)};
+	};
+}
+
+parsed_t
+parse_day7(const std::string_view contents) {
+	auto arena = std::make_unique<arena::arena_t>(contents.size() * 4);
+	auto hands = hands_cache::parse(contents, arena->resource());
+	return [state = in_arena_t{std::move(arena), std::move(hands)}]() -> answers_t {
+		return {camel_cards::calc_total_winnings_simple(*state.parsed),
+		        camel_cards::calc_total_winnings_complex(*state.parsed)};
+	};
+}
+
+const std::vector<day_t> all{
+    {"1", "day1/data/1.in", parse_day1},
+    {"3", "day3/data/3.in", parse_day3},
+    {"5", "day5/data/5.in", parse_day5},
+    {"7", "day7/data/7.in", parse_day7},
+};
+
+}   // namespace days
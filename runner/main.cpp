@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "../common/input.hpp"
+#include "../common/pool.hpp"
+#include "batch.hpp"
+#include "days.hpp"
+
+// Runs any subset of the C++ days in one process, concurrently, on one team of OpenMP
+// threads which the days' own parallel loops share (see common/pool.hpp).
+//
+//   runner [--threads N] [day[=input] ...]
+//
+// or solves one day over every input in a directory, or listed in a manifest file,
+// reading and parsing ahead of the solver (see batch.hpp).
+//
+//   runner [--threads N] [--queue N] --batch day (directory | manifest)
+
+const days::day_t *
+find_day(const std::string &name) {
+	const auto day = std::find_if(days::all.begin(), days::all.end(),
+	                              [&](const auto &d) { return d.name == name; });
+
+	if (day == days::all.end()) {
+		std::cout << "fatal: no C++ solution for day " << name << std::endl;
+		return nullptr;
+	}
+
+	return &*day;
+}
+
+typedef struct Job {
+		const days::day_t *day;
+		std::string filepath;
+		std::optional<input::mapped_file_t> file;
+		days::answers_t answers;
+		double ms;
+} job_t;
+
+int
+main(int argc, char *argv[]) {
+	std::vector<job_t> jobs;
+	std::optional<std::pair<std::string, std::string>> batch_of;
+	size_t queue_size = 4;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg{argv[i]};
+
+		if (arg == "--threads" && i + 1 < argc) {
+			omp_set_num_threads(std::stoi(argv[++i]));
+			continue;
+		}
+		if (arg == "--queue" && i + 1 < argc) {
+			queue_size = std::stoul(argv[++i]);
+			continue;
+		}
+		if (arg == "--batch" && i + 2 < argc) {
+			batch_of = {argv[i + 1], argv[i + 2]};
+			i += 2;
+			continue;
+		}
+
+		const auto eq = arg.find('=');
+		const auto day = find_day(arg.substr(0, eq));
+
+		if (day == nullptr) {
+			return EXIT_FAILURE;
+		}
+
+		jobs.push_back({day, eq == std::string::npos ? day->filepath : arg.substr(eq + 1),
+		                std::nullopt, {0, 0}, 0});
+	}
+
+	if (batch_of.has_value()) {
+		const auto day = find_day(batch_of->first);
+		const auto inputs = batch::list_inputs(batch_of->second);
+
+		if (day == nullptr) {
+			return EXIT_FAILURE;
+		}
+		if (!inputs.has_value()) {
+			std::cout << "fatal: file not found: " << batch_of->second << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const auto summary = batch::run(*day, *inputs, queue_size);
+		batch::print(summary);
+
+		return summary.n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (jobs.empty()) {
+		for (const auto &day : days::all) {
+			jobs.push_back({&day, day.filepath, std::nullopt, {0, 0}, 0});
+		}
+	}
+
+	for (auto &job : jobs) {
+		job.file = input::map_file(job.filepath);
+
+		if (!job.file.has_value()) {
+			std::cout << "fatal: file not found: " << job.filepath << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	pool::run([&]() {
+		for (size_t i = 0; i < jobs.size(); i++) {
+			job_t *job = &jobs[i];
+
+#pragma omp task firstprivate(job)
+			{
+				const auto job_start = std::chrono::steady_clock::now();
+				job->answers = job->day->solve(job->file->contents());
+				job->ms = batch::ms_since(job_start);
+			}
+		}
+
+#pragma omp taskwait
+	});
+
+	const double total_ms = batch::ms_since(start);
+
+	std::cout << std::fixed << std::setprecision(3);
+	for (const auto &job : jobs) {
+		std::cout << "day " << std::left << std::setw(3) << job.day->name
+		          << "part one: " << std::setw(14) << job.answers.part_one
+		          << "part two: " << std::setw(14) << job.answers.part_two << std::right
+		          << std::setw(12) << job.ms << "ms" << std::endl;
+	}
+
+	std::cout << std::endl
+	          << "total: " << total_ms << "ms on " << omp_get_max_threads() << " threads"
+	          << std::endl;
+
+	return EXIT_SUCCESS;
+}
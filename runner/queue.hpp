@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace queue {
+
+// A blocking FIFO holding at most `capacity` items, so a fast producer waits for the
+// consumer rather than reading ahead without limit. Closing it lets the consumer drain
+// what is left and then see the end.
+template <typename T>
+struct bounded_queue_t {
+		const size_t capacity;
+		std::mutex mutex;
+		std::condition_variable not_full;
+		std::condition_variable not_empty;
+		std::deque<T> items;
+		bool is_closed = false;
+
+		explicit bounded_queue_t(const size_t capacity) : capacity(capacity) {
+		}
+
+		void push(T item) {
+			std::unique_lock lock(mutex);
+			not_full.wait(lock, [&]() { return items.size() < capacity; });
+			items.push_back(std::move(item));
+			not_empty.notify_one();
+		}
+
+		// nullopt once the queue is closed and empty
+		std::optional<T> pop() {
+			std::unique_lock lock(mutex);
+			not_empty.wait(lock, [&]() { return !items.empty() || is_closed; });
+
+			if (items.empty()) {
+				return std::nullopt;
+			}
+
+			T item = std::move(items.front());
+			items.pop_front();
+			not_full.notify_one();
+			return item;
+		}
+
+		void close() {
+			std::lock_guard lock(mutex);
+			is_closed = true;
+			not_empty.notify_all();
+		}
+};
+
+}   // namespace queue